@@ -0,0 +1,84 @@
+#ifndef BLOCKARENA_H
+#define BLOCKARENA_H
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <vector>
+
+// Хранилище блоков блочной матрицы одним куском памяти: все присутствующие
+// блоки лежат подряд в выровненном по строке кэша массиве в порядке номеров
+// (bi * blockCols + bj). Индекс компактный: битовая карта присутствия и для
+// каждого 64-битного слова карты число присутствующих блоков до него, так что
+// смещение блока - префиксная сумма плюс popcount младших битов слова.
+// Одно выделение памяти на матрицу, копирование - один memcpy.
+template <typename T>
+class BlockArena {
+public:
+    static constexpr size_t alignment = 64;
+
+    // blockCount - число позиций, present(index) - есть ли блок на позиции.
+    // Блоки от строки кэша и больше начинаются на границе строки кэша,
+    // мелкие лежат вплотную
+    template <typename Present>
+    BlockArena(size_t blockCount, size_t blockElems, Present present)
+        : _blockElems(blockElems), bits((blockCount + 63) / 64, 0), offsets(bits.size() + 1, 0) {
+        size_t lineElems = std::max<size_t>(1, alignment / sizeof(T));
+        _stride = blockElems * sizeof(T) >= alignment ? (blockElems + lineElems - 1) / lineElems * lineElems
+                                                      : blockElems;
+        for (size_t index = 0; index < blockCount; ++index) {
+            if (present(index)) bits[index / 64] |= uint64_t(1) << (index % 64);
+        }
+        for (size_t w = 0; w < bits.size(); ++w) {
+            offsets[w + 1] = offsets[w] + static_cast<size_t>(std::popcount(bits[w]));
+        }
+        allocate();
+        std::fill(slab.get(), slab.get() + size(), T());
+    }
+
+    BlockArena(const BlockArena& other)
+        : _blockElems(other._blockElems), _stride(other._stride), bits(other.bits), offsets(other.offsets) {
+        allocate();
+        std::copy(other.slab.get(), other.slab.get() + size(), slab.get());
+    }
+
+    BlockArena& operator=(const BlockArena&) = delete;
+
+    size_t blockCount() const { return offsets.back(); }
+    size_t blockElems() const { return _blockElems; }
+
+    // Начало блока на позиции index или nullptr, если блока нет
+    const T* data(size_t index) const {
+        uint64_t word = bits[index / 64];
+        uint64_t bit = uint64_t(1) << (index % 64);
+        if (!(word & bit)) return nullptr;
+        size_t rank = offsets[index / 64] + static_cast<size_t>(std::popcount(word & (bit - 1)));
+        return slab.get() + rank * _stride;
+    }
+
+    T* data(size_t index) {
+        return const_cast<T*>(static_cast<const BlockArena&>(*this).data(index));
+    }
+
+private:
+    struct SlabDeleter {
+        void operator()(T* p) const { ::operator delete(p, std::align_val_t(alignment)); }
+    };
+
+    size_t _blockElems;
+    size_t _stride;
+    std::vector<uint64_t> bits;
+    std::vector<size_t> offsets;
+    std::unique_ptr<T[], SlabDeleter> slab;
+
+    size_t size() const { return blockCount() * _stride; }
+
+    void allocate() {
+        size_t bytes = std::max<size_t>(1, size()) * sizeof(T);
+        slab.reset(static_cast<T*>(::operator new(bytes, std::align_val_t(alignment))));
+    }
+};
+
+#endif
@@ -0,0 +1,190 @@
+#ifndef GEMM_H
+#define GEMM_H
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include "ThreadPool.h"
+
+// Блочное умножение плотных матриц в построчном хранении:
+// C = alpha * A * B + beta * C, где A - m x k, B - k x n, C - m x n.
+//
+// Схема как в GotoBLAS/BLIS: B режется на панели kc x nc (под L3) и упаковывается
+// в полоски шириной NR, A - на блоки mc x kc (под L2) и упаковывается в полоски
+// высотой MR. Микроядро держит плиту MR x NR результата в регистрах и проходит
+// по упакованным полоскам подряд (под L1), поэтому внутренний цикл читает память
+// строго последовательно и векторизуется компилятором по NR.
+//
+// Параллельная версия делит C на сетку плиток pr x pc по числу потоков и
+// считает каждую плитку последовательным алгоритмом в общем пуле потоков.
+template <typename T>
+struct Gemm {
+    static constexpr unsigned MR = 4;
+    static constexpr unsigned NR = 16 / sizeof(T) >= 4 ? 16 : 8;
+    static constexpr unsigned MC = 128;
+    static constexpr unsigned KC = 256;
+    static constexpr unsigned NC = 2048;
+
+    // numThreads = 0 - все потоки общего пула
+    static void multiply(unsigned m, unsigned n, unsigned k, T alpha,
+                         const T* A, unsigned lda, const T* B, unsigned ldb,
+                         T beta, T* C, unsigned ldc, unsigned numThreads = 0) {
+        ThreadPool& pool = ThreadPool::shared();
+        if (numThreads == 0) numThreads = pool.size();
+        // Мелкие произведения не окупают раздачу заданий
+        if (static_cast<double>(m) * n * k < parallelThreshold) numThreads = 1;
+
+        unsigned pr, pc;
+        tileGrid(m, n, numThreads, pr, pc);
+        if (pr * pc == 1) {
+            multiplyTile(m, n, k, alpha, A, lda, B, ldb, beta, C, ldc);
+            return;
+        }
+
+        // Границы плиток кратны MR и NR, чтобы микроядро реже работало с неполными плитами
+        unsigned tileM = roundUp((m + pr - 1) / pr, MR);
+        unsigned tileN = roundUp((n + pc - 1) / pc, NR);
+        pr = (m + tileM - 1) / tileM;
+        pc = (n + tileN - 1) / tileN;
+        pool.parallelFor(pr * pc, numThreads, [=](unsigned t) {
+            unsigned i = (t / pc) * tileM;
+            unsigned j = (t % pc) * tileN;
+            multiplyTile(std::min(tileM, m - i), std::min(tileN, n - j), k, alpha,
+                         A + static_cast<size_t>(i) * lda, lda, B + j, ldb,
+                         beta, C + static_cast<size_t>(i) * ldc + j, ldc);
+        });
+    }
+
+    // Сетка pr x pc = p плиток с наименьшим объемом чтения: плитка читает
+    // m/pr строк A и n/pc столбцов B, поэтому минимизируется m/pr + n/pc.
+    // Плитка не делается уже одной плиты микроядра, если без этого можно обойтись.
+    static void tileGrid(unsigned m, unsigned n, unsigned p, unsigned& pr, unsigned& pc) {
+        unsigned maxRows = std::max(1u, (m + MR - 1) / MR);
+        unsigned maxCols = std::max(1u, (n + NR - 1) / NR);
+        p = std::max(1u, std::min(p, maxRows * maxCols));
+        pr = 1;
+        pc = 1;
+        double bestCost = -1;
+        for (unsigned r = 1; r <= p; ++r) {
+            if (p % r != 0) continue;
+            unsigned c = p / r;
+            if (r > maxRows || c > maxCols) continue;
+            double cost = static_cast<double>(m) / r + static_cast<double>(n) / c;
+            if (bestCost < 0 || cost < bestCost) {
+                bestCost = cost;
+                pr = r;
+                pc = c;
+            }
+        }
+        // Простое p, не влезающее ни по строкам, ни по столбцам: берем сколько помещается
+        if (bestCost < 0) {
+            pr = std::min(p, maxRows);
+            pc = std::min(p / pr, maxCols);
+        }
+    }
+
+private:
+    static constexpr double parallelThreshold = 64.0 * 64.0 * 64.0;
+
+    static unsigned roundUp(unsigned value, unsigned step) {
+        return (value + step - 1) / step * step;
+    }
+
+    // Последовательное умножение одной плитки
+    static void multiplyTile(unsigned m, unsigned n, unsigned k, T alpha,
+                             const T* A, unsigned lda, const T* B, unsigned ldb,
+                             T beta, T* C, unsigned ldc) {
+        // beta применяется один раз заранее, дальше блоки только накапливаются
+        for (unsigned i = 0; i < m; ++i) {
+            T* row = C + static_cast<size_t>(i) * ldc;
+            if (beta == T()) {
+                std::fill(row, row + n, T());
+            } else if (beta != T(1)) {
+                for (unsigned j = 0; j < n; ++j) row[j] *= beta;
+            }
+        }
+        if (k == 0 || alpha == T()) return;
+
+        // Буферы упаковки свои у каждого потока и живут между вызовами
+        thread_local std::vector<T> packedA(static_cast<size_t>(MC) * KC);
+        thread_local std::vector<T> packedB(static_cast<size_t>(KC) * (NC + NR));
+
+        for (unsigned jc = 0; jc < n; jc += NC) {
+            unsigned nc = std::min(NC, n - jc);
+            for (unsigned pc = 0; pc < k; pc += KC) {
+                unsigned kc = std::min(KC, k - pc);
+                packB(kc, nc, B + static_cast<size_t>(pc) * ldb + jc, ldb, packedB.data());
+                for (unsigned ic = 0; ic < m; ic += MC) {
+                    unsigned mc = std::min(MC, m - ic);
+                    packA(mc, kc, A + static_cast<size_t>(ic) * lda + pc, lda, packedA.data());
+                    macroKernel(mc, nc, kc, alpha, packedA.data(), packedB.data(),
+                                C + static_cast<size_t>(ic) * ldc + jc, ldc);
+                }
+            }
+        }
+    }
+
+    // Полоски по MR строк A: элементы одного столбца полоски лежат подряд.
+    // Неполная последняя полоска дополняется нулями.
+    static void packA(unsigned mc, unsigned kc, const T* A, unsigned lda, T* out) {
+        for (unsigned i = 0; i < mc; i += MR) {
+            unsigned mr = std::min(MR, mc - i);
+            for (unsigned p = 0; p < kc; ++p) {
+                for (unsigned r = 0; r < MR; ++r) {
+                    *out++ = r < mr ? A[static_cast<size_t>(i + r) * lda + p] : T();
+                }
+            }
+        }
+    }
+
+    // Полоски по NR столбцов B: элементы одной строки полоски лежат подряд
+    static void packB(unsigned kc, unsigned nc, const T* B, unsigned ldb, T* out) {
+        for (unsigned j = 0; j < nc; j += NR) {
+            unsigned nr = std::min(NR, nc - j);
+            for (unsigned p = 0; p < kc; ++p) {
+                const T* row = B + static_cast<size_t>(p) * ldb + j;
+                for (unsigned c = 0; c < NR; ++c) {
+                    *out++ = c < nr ? row[c] : T();
+                }
+            }
+        }
+    }
+
+    static void macroKernel(unsigned mc, unsigned nc, unsigned kc, T alpha,
+                            const T* packedA, const T* packedB, T* C, unsigned ldc) {
+        for (unsigned j = 0; j < nc; j += NR) {
+            unsigned nr = std::min(NR, nc - j);
+            const T* b = packedB + static_cast<size_t>(j) * kc;
+            for (unsigned i = 0; i < mc; i += MR) {
+                unsigned mr = std::min(MR, mc - i);
+                const T* a = packedA + static_cast<size_t>(i) * kc;
+                microKernel(kc, alpha, a, b, C + static_cast<size_t>(i) * ldc + j, ldc, mr, nr);
+            }
+        }
+    }
+
+    // Плита MR x NR: kc шагов ранга 1 в локальном аккумуляторе
+    static void microKernel(unsigned kc, T alpha, const T* __restrict a, const T* __restrict b,
+                            T* C, unsigned ldc, unsigned mr, unsigned nr) {
+        T acc[MR][NR] = {};
+        for (unsigned p = 0; p < kc; ++p) {
+            for (unsigned r = 0; r < MR; ++r) {
+                T av = a[r];
+                for (unsigned c = 0; c < NR; ++c) {
+                    acc[r][c] += av * b[c];
+                }
+            }
+            a += MR;
+            b += NR;
+        }
+        for (unsigned r = 0; r < mr; ++r) {
+            T* row = C + static_cast<size_t>(r) * ldc;
+            for (unsigned c = 0; c < nr; ++c) {
+                row[c] += alpha * acc[r][c];
+            }
+        }
+    }
+};
+
+#endif
@@ -6,6 +6,9 @@
 #include <string>
 #include <iostream>
 
+// Способ хранения матрицы: по нему операции выбирают быстрый путь
+enum class MatrixStructure { General, Dense, Diagonal, Block, Sparse, Kronecker };
+
 template <typename T = double>
 class Matrix {
 public:
@@ -17,6 +20,42 @@ public:
     // Доступ к элементам
     virtual T operator()(unsigned i, unsigned j) const = 0;
 
+    // Пакетный доступ: один виртуальный вызов на строку или плитку вместо
+    // вызова на каждый элемент
+
+    virtual MatrixStructure structure() const { return MatrixStructure::General; }
+
+    // Строка i, если она хранится подряд целиком, иначе nullptr
+    virtual const T* rowData(unsigned) const { return nullptr; }
+
+    // Копирует count элементов строки i, начиная со столбца j, в out
+    virtual void copyRow(unsigned i, unsigned j, unsigned count, T* out) const {
+        for (unsigned k = 0; k < count; ++k) {
+            out[k] = (*this)(i, j + k);
+        }
+    }
+
+    // Копирует плитку m x n с левым верхним углом (i, j) в out с шагом строк ldo
+    virtual void copyTile(unsigned i, unsigned j, unsigned m, unsigned n, T* out, unsigned ldo) const {
+        for (unsigned r = 0; r < m; ++r) {
+            copyRow(i + r, j, n, out + static_cast<size_t>(r) * ldo);
+        }
+    }
+
+    // Произведения на диагональную матрицу diag(d) с сохранением структуры:
+    // diag(d) * this и this * diag(d). nullptr - хранение не поддерживает
+    // масштабирование, вызывающий считает произведение общим способом
+    virtual Matrix<T>* scaleRows(const T*) const { return nullptr; }
+    virtual Matrix<T>* scaleCols(const T*) const { return nullptr; }
+
+    // Строка i целиком: указатель в хранилище, если она лежит подряд, иначе копия в buffer
+    const T* readRow(unsigned i, T* buffer) const {
+        const T* row = rowData(i);
+        if (row) return row;
+        copyRow(i, 0, cols(), buffer);
+        return buffer;
+    }
+
     // Операции с матрицами
     virtual Matrix<T>& operator+=(const Matrix<T>& other) = 0;
     virtual Matrix<T>& operator-=(const Matrix<T>& other) = 0;
@@ -31,6 +70,10 @@ public:
     virtual void importFromFile(const std::string& filename) = 0;
     virtual void exportToFile(const std::string& filename) const = 0;
 
+    // Двоичный формат (MatrixFile.h): без потери точности и без разбора текста
+    virtual void importFromBinary(const std::string& filename) = 0;
+    virtual void exportToBinary(const std::string& filename) const = 0;
+
     // Метод для печати матрицы
     virtual void print(std::ostream& os = std::cout) const = 0;
 };
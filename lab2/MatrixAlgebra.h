@@ -0,0 +1,128 @@
+#ifndef MATRIXALGEBRA_H
+#define MATRIXALGEBRA_H
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+#include "Matrix.h"
+#include "MatrixDense.h"
+#include "Gemm.h"
+#include "ThreadPool.h"
+
+// Матричные операции без new/delete на стороне вызывающего.
+// Версии, возвращающие значение, отдают MatrixDense перемещением.
+// Версии с приемником пишут в заранее выделенную матрицу C нужного размера
+// и в установившемся цикле не выделяют памяти: неплотные операнды копируются
+// в буферы потока, которые переиспользуются между вызовами.
+// numThreads = 0 - все потоки общего пула.
+struct MatrixAlgebra {
+
+    template <typename T>
+    static MatrixDense<T> multiply(const Matrix<T>& A, const Matrix<T>& B, unsigned numThreads = 0) {
+        MatrixDense<T> C(A.rows(), B.cols());
+        multiply(A, B, C, numThreads);
+        return C;
+    }
+
+    template <typename T>
+    static MatrixDense<T> add(const Matrix<T>& A, const Matrix<T>& B, unsigned numThreads = 0) {
+        MatrixDense<T> C(A.rows(), A.cols());
+        add(A, B, C, numThreads);
+        return C;
+    }
+
+    template <typename T>
+    static MatrixDense<T> subtract(const Matrix<T>& A, const Matrix<T>& B, unsigned numThreads = 0) {
+        MatrixDense<T> C(A.rows(), A.cols());
+        subtract(A, B, C, numThreads);
+        return C;
+    }
+
+    // C = A * B
+    template <typename T>
+    static void multiply(const Matrix<T>& A, const Matrix<T>& B, MatrixDense<T>& C, unsigned numThreads = 0) {
+        gemm(T(1), A, B, T(), C, numThreads);
+    }
+
+    // C = alpha * A * B + beta * C; C не может совпадать с A или B
+    template <typename T>
+    static void gemm(T alpha, const Matrix<T>& A, const Matrix<T>& B, T beta, MatrixDense<T>& C,
+                     unsigned numThreads = 0) {
+        if (A.cols() != B.rows()) {
+            throw std::invalid_argument("Внутренние размеры матриц должны совпадать для умножения.");
+        }
+        checkDestination(C, A.rows(), B.cols());
+        if (&C == &A || &C == &B) {
+            throw std::invalid_argument("Матрица-приемник не должна совпадать с множителем.");
+        }
+        if (C.rows() == 0 || C.cols() == 0) return;
+
+        thread_local std::vector<T> bufferA, bufferB;
+        const T* a = rowMajor(A, bufferA);
+        const T* b = rowMajor(B, bufferB);
+        Gemm<T>::multiply(A.rows(), B.cols(), A.cols(), alpha, a, A.cols(), b, B.cols(),
+                          beta, &C(0, 0), C.cols(), numThreads);
+    }
+
+    // C = A + B; C может совпадать с A или B
+    template <typename T>
+    static void add(const Matrix<T>& A, const Matrix<T>& B, MatrixDense<T>& C, unsigned numThreads = 0) {
+        combine(A, B, C, [](T a, T b) { return a + b; }, numThreads);
+    }
+
+    // C = A - B; C может совпадать с A или B
+    template <typename T>
+    static void subtract(const Matrix<T>& A, const Matrix<T>& B, MatrixDense<T>& C, unsigned numThreads = 0) {
+        combine(A, B, C, [](T a, T b) { return a - b; }, numThreads);
+    }
+
+private:
+    template <typename T>
+    static void checkDestination(const MatrixDense<T>& C, unsigned m, unsigned n) {
+        if (C.rows() != m || C.cols() != n) {
+            throw std::invalid_argument("Размеры матрицы-приемника не совпадают с размерами результата.");
+        }
+    }
+
+    // Построчное хранение матрицы: плотная отдается как есть, остальные
+    // копируются одной плиткой в buffer
+    template <typename T>
+    static const T* rowMajor(const Matrix<T>& M, std::vector<T>& buffer) {
+        if (M.structure() == MatrixStructure::Dense) return M.rowData(0);
+        buffer.resize(static_cast<size_t>(M.rows()) * M.cols());
+        M.copyTile(0, 0, M.rows(), M.cols(), buffer.data(), M.cols());
+        return buffer.data();
+    }
+
+    // Построчно полосами в общем пуле; строки неплотных операндов читаются в буферы потока
+    template <typename T, typename Op>
+    static void combine(const Matrix<T>& A, const Matrix<T>& B, MatrixDense<T>& C, Op op, unsigned numThreads) {
+        if (A.rows() != B.rows() || A.cols() != B.cols()) {
+            throw std::invalid_argument("Размеры матриц должны совпадать для поэлементной операции.");
+        }
+        unsigned m = A.rows();
+        unsigned n = A.cols();
+        checkDestination(C, m, n);
+        if (m == 0 || n == 0) return;
+
+        unsigned rowsPerTask = std::max(1u, (1u << 14) / n);
+        unsigned tasks = (m + rowsPerTask - 1) / rowsPerTask;
+        ThreadPool::shared().parallelFor(tasks, numThreads, [&](unsigned t) {
+            thread_local std::vector<T> bufferA, bufferB;
+            bufferA.resize(n);
+            bufferB.resize(n);
+            unsigned end = std::min(m, (t + 1) * rowsPerTask);
+            for (unsigned i = t * rowsPerTask; i < end; ++i) {
+                const T* a = A.readRow(i, bufferA.data());
+                const T* b = B.readRow(i, bufferB.data());
+                T* c = &C(i, 0);
+                for (unsigned j = 0; j < n; ++j) {
+                    c[j] = op(a[j], b[j]);
+                }
+            }
+        });
+    }
+};
+
+#endif
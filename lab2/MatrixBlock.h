@@ -5,8 +5,14 @@
 
 #include "Matrix.h"
 #include "MatrixDense.h"
+#include "MatrixFile.h"
+#include "TextCodec.h"
+#include "ThreadPool.h"
+#include "BlockArena.h"
 #include <vector>
+#include <cstdint>
 #include <memory>
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <stdexcept>
@@ -17,6 +23,147 @@ private:
     unsigned _blockRows, _blockCols;         // Количество блоков по строкам и столбцам
     unsigned _blockSizeM, _blockSizeN;       // Размер каждого блока
     std::vector<std::vector<std::shared_ptr<MatrixDense<T>>>> blocks;
+    std::shared_ptr<BlockArena<T>> arena;    // Режим арены (pack): blocks пуст, блоки лежат в arena
+
+    size_t blockIndex(unsigned bi, unsigned bj) const { return static_cast<size_t>(bi) * _blockCols + bj; }
+
+    // Начало блока (bi, bj) в построчном хранении или nullptr, если блока нет
+    const T* blockData(unsigned bi, unsigned bj) const {
+        if (arena) return arena->data(blockIndex(bi, bj));
+        const auto& block = blocks[bi][bj];
+        return block ? block->rowData(0) : nullptr;
+    }
+
+    // Блок (bi, bj) для записи; отсутствующий создается нулевым. Новый блок
+    // меняет структуру, поэтому матрица в режиме арены сначала распаковывается.
+    // Блок или арена, общие с другой матрицей, сначала копируются (копирование при записи)
+    T* writableBlock(unsigned bi, unsigned bj) {
+        if (arena) {
+            if (arena->data(blockIndex(bi, bj))) return ownArena().data(blockIndex(bi, bj));
+            unpack();
+        }
+        auto& block = blocks[bi][bj];
+        if (!block) {
+            block = std::make_shared<MatrixDense<T>>(_blockSizeM, _blockSizeN);
+        } else if (block.use_count() > 1) {
+            block = std::make_shared<MatrixDense<T>>(*block);
+        }
+        return &(*block)(0, 0);
+    }
+
+    // Арена только этой матрицы: общая с копиями дублируется одним куском
+    BlockArena<T>& ownArena() {
+        if (arena.use_count() > 1) arena = std::make_shared<BlockArena<T>>(*arena);
+        return *arena;
+    }
+
+    // Копия разделяет блоки (или арену) с other: копирование стоит O(число блоков),
+    // а данные блока дублируются при первой записи в него через writableBlock
+    void copyBlocks(const MatrixBlock<T>& other) {
+        arena = other.arena;
+        blocks = other.blocks;
+    }
+
+    // func(bi) для блочных строк полосами в общем пуле потоков; в полосе
+    // около 16K элементов, чтобы мелкие блоки не дробили работу на задания
+    template <typename Func>
+    void forBlockRows(unsigned blockRows, size_t elemsPerBlockRow, Func func) const {
+        size_t perTask = (size_t(1) << 14) / std::max<size_t>(1, elemsPerBlockRow);
+        unsigned rowsPerTask = static_cast<unsigned>(std::clamp<size_t>(perTask, 1, std::max(1u, blockRows)));
+        unsigned tasks = (blockRows + rowsPerTask - 1) / rowsPerTask;
+        ThreadPool::shared().parallelFor(tasks, 0, [&](unsigned t) {
+            unsigned end = std::min(blockRows, (t + 1) * rowsPerTask);
+            for (unsigned bi = t * rowsPerTask; bi < end; ++bi) func(bi);
+        });
+    }
+
+    // Новая матрица той же структуры: scale(bi, bj, r, c) - множитель элемента (r, c)
+    // блока (bi, bj)
+    template <typename Scale>
+    MatrixBlock<T>* scaleBlocks(Scale scale) const {
+        MatrixBlock<T>* result = new MatrixBlock<T>(_blockRows, _blockCols, _blockSizeM, _blockSizeN);
+        forBlockRows(_blockRows, static_cast<size_t>(_blockSizeM) * cols(), [&](unsigned bi) {
+            for (unsigned bj = 0; bj < _blockCols; ++bj) {
+                const T* src = blockData(bi, bj);
+                if (!src) continue;
+                T* dst = result->writableBlock(bi, bj);
+                for (unsigned r = 0; r < _blockSizeM; ++r) {
+                    for (unsigned c = 0; c < _blockSizeN; ++c) {
+                        size_t k = static_cast<size_t>(r) * _blockSizeN + c;
+                        dst[k] = scale(bi, bj, r, c) * src[k];
+                    }
+                }
+            }
+        });
+        result->inheritMode(*this);
+        return result;
+    }
+
+    // Результат операции хранится так же, как исходная матрица
+    void inheritMode(const MatrixBlock<T>& source) {
+        if (source.packed()) pack();
+    }
+
+    // Какие пары блоков участвуют в поблочной операции: для сложения и вычитания
+    // пара пустых блоков дает пустой блок, для почленного умножения - пара,
+    // где пуст хотя бы один; деление проходит все блоки (0 / 0 - ошибка)
+    enum class BlockPattern { Union, Intersection, Full };
+
+    // Поблочно: блок (bi, bj) результата = op(блок this, та же плитка other).
+    // У блочной other с тем же разбиением блоки берутся напрямую, у остальных
+    // плитка читается одним copyTile в буфер потока. Пары, которые по pattern
+    // дают нулевой блок, пропускаются без чтения. Блок результата хранится,
+    // только если в нем есть ненулевые элементы. Блочные строки независимы и
+    // считаются параллельно. out может совпадать с *this; в режиме арены out
+    // на время операции распаковывается, так как набор блоков может измениться
+    template <typename Op>
+    void combineBlocks(const Matrix<T>& other, MatrixBlock<T>& out, BlockPattern pattern, Op op) const {
+        bool repack = out.packed();
+        out.unpack();
+        const MatrixBlock<T>* right = nullptr;
+        if (other.structure() == MatrixStructure::Block) {
+            right = static_cast<const MatrixBlock<T>*>(&other);
+            if (right->_blockSizeM != _blockSizeM || right->_blockSizeN != _blockSizeN) right = nullptr;
+        }
+        size_t blockElems = static_cast<size_t>(_blockSizeM) * _blockSizeN;
+        forBlockRows(_blockRows, blockElems * _blockCols, [&](unsigned bi) {
+            thread_local std::vector<T> tile;
+            tile.resize(blockElems);
+            for (unsigned bj = 0; bj < _blockCols; ++bj) {
+                const T* own = blockData(bi, bj);
+                const T* src = nullptr;
+                if (right) {
+                    src = right->blockData(bi, bj);
+                }
+                bool skip = (pattern == BlockPattern::Intersection && (!own || (right && !src))) ||
+                            (pattern == BlockPattern::Union && !own && right && !src);
+                if (skip) {
+                    out.blocks[bi][bj] = nullptr;
+                    continue;
+                }
+                if (!src) {
+                    other.copyTile(bi * _blockSizeM, bj * _blockSizeN, _blockSizeM, _blockSizeN,
+                                   tile.data(), _blockSizeN);
+                    src = tile.data();
+                }
+                bool nonzero = false;
+                for (size_t k = 0; k < blockElems; ++k) {
+                    tile[k] = op(own ? own[k] : T(), src[k]);
+                    nonzero = nonzero || tile[k] != T();
+                }
+                if (!nonzero) {
+                    out.blocks[bi][bj] = nullptr;
+                    continue;
+                }
+                // Блок, общий с копией, не перезаписывается, а заменяется новым
+                if (!out.blocks[bi][bj] || out.blocks[bi][bj].use_count() > 1) {
+                    out.blocks[bi][bj] = std::make_shared<MatrixDense<T>>(_blockSizeM, _blockSizeN);
+                }
+                std::copy(tile.begin(), tile.end(), &(*out.blocks[bi][bj])(0, 0));
+            }
+        });
+        if (repack) out.pack();
+    }
 
 public:
     // Конструктор
@@ -25,25 +172,18 @@ public:
         blocks.resize(_blockRows, std::vector<std::shared_ptr<MatrixDense<T>>>(_blockCols, nullptr));
     }
 
-    // Конструктор копирования
+    // Конструктор копирования: блоки общие до первой записи
     MatrixBlock(const MatrixBlock<T>& other)
         : _blockRows(other._blockRows), _blockCols(other._blockCols),
           _blockSizeM(other._blockSizeM), _blockSizeN(other._blockSizeN) {
-        blocks.resize(_blockRows, std::vector<std::shared_ptr<MatrixDense<T>>>(_blockCols, nullptr));
-        for (unsigned i = 0; i < _blockRows; ++i) {
-            for (unsigned j = 0; j < _blockCols; ++j) {
-                if (other.blocks[i][j]) {
-                    blocks[i][j] = std::make_shared<MatrixDense<T>>(*other.blocks[i][j]);
-                }
-            }
-        }
+        copyBlocks(other);
     }
 
     // Конструктор перемещения
     MatrixBlock(MatrixBlock<T>&& other) noexcept
         : _blockRows(other._blockRows), _blockCols(other._blockCols),
           _blockSizeM(other._blockSizeM), _blockSizeN(other._blockSizeN),
-          blocks(std::move(other.blocks)) {
+          blocks(std::move(other.blocks)), arena(std::move(other.arena)) {
         other._blockRows = 0;
         other._blockCols = 0;
         other._blockSizeM = 0;
@@ -62,15 +202,7 @@ public:
             _blockCols = other._blockCols;
             _blockSizeM = other._blockSizeM;
             _blockSizeN = other._blockSizeN;
-
-            blocks.resize(_blockRows, std::vector<std::shared_ptr<MatrixDense<T>>>(_blockCols, nullptr));
-            for (unsigned i = 0; i < _blockRows; ++i) {
-                for (unsigned j = 0; j < _blockCols; ++j) {
-                    if (other.blocks[i][j]) {
-                        blocks[i][j] = std::make_shared<MatrixDense<T>>(*other.blocks[i][j]);
-                    }
-                }
-            }
+            copyBlocks(other);
         }
         return *this;
     }
@@ -83,6 +215,7 @@ public:
             _blockSizeM = other._blockSizeM;
             _blockSizeN = other._blockSizeN;
             blocks = std::move(other.blocks);
+            arena = std::move(other.arena);
 
             other._blockRows = 0;
             other._blockCols = 0;
@@ -92,14 +225,90 @@ public:
         return *this;
     }
 
+    // Режим арены: все блоки переносятся в один выровненный кусок памяти
+    // (одно выделение на матрицу, соседние блоки рядом в памяти). Результаты
+    // операций над такой матрицей тоже упакованы. Запись, добавляющая блок,
+    // возвращает матрицу в обычный режим
+    void pack() {
+        if (arena) return;
+        size_t blockElems = static_cast<size_t>(_blockSizeM) * _blockSizeN;
+        arena = std::make_shared<BlockArena<T>>(static_cast<size_t>(_blockRows) * _blockCols, blockElems,
+            [&](size_t index) { return blocks[index / _blockCols][index % _blockCols] != nullptr; });
+        for (unsigned bi = 0; bi < _blockRows; ++bi) {
+            for (unsigned bj = 0; bj < _blockCols; ++bj) {
+                if (blocks[bi][bj]) {
+                    const T* src = blocks[bi][bj]->rowData(0);
+                    std::copy(src, src + blockElems, arena->data(blockIndex(bi, bj)));
+                }
+            }
+        }
+        blocks.clear();
+    }
+
+    // Обратно к отдельному MatrixDense на каждый блок
+    void unpack() {
+        if (!arena) return;
+        size_t blockElems = static_cast<size_t>(_blockSizeM) * _blockSizeN;
+        blocks.assign(_blockRows, std::vector<std::shared_ptr<MatrixDense<T>>>(_blockCols, nullptr));
+        for (unsigned bi = 0; bi < _blockRows; ++bi) {
+            for (unsigned bj = 0; bj < _blockCols; ++bj) {
+                if (const T* src = arena->data(blockIndex(bi, bj))) {
+                    blocks[bi][bj] = std::make_shared<MatrixDense<T>>(_blockSizeM, _blockSizeN);
+                    std::copy(src, src + blockElems, &(*blocks[bi][bj])(0, 0));
+                }
+            }
+        }
+        arena.reset();
+    }
+
+    bool packed() const { return arena != nullptr; }
+
+    // Разбиение на блоки и данные блока (nullptr - нулевой блок)
+    unsigned blockRows() const { return _blockRows; }
+    unsigned blockCols() const { return _blockCols; }
+    unsigned blockSizeM() const { return _blockSizeM; }
+    unsigned blockSizeN() const { return _blockSizeN; }
+    const T* block(unsigned bi, unsigned bj) const { return blockData(bi, bj); }
+
     unsigned rows() const override { return _blockRows * _blockSizeM; }
     unsigned cols() const override { return _blockCols * _blockSizeN; }
 
+    MatrixStructure structure() const override { return MatrixStructure::Block; }
+
+    // Строка собирается из отрезков блоков одной блочной строки
+    void copyRow(unsigned i, unsigned j, unsigned count, T* out) const override {
+        unsigned blockRow = i / _blockSizeM;
+        unsigned localRow = i % _blockSizeM;
+        unsigned k = 0;
+        while (k < count) {
+            unsigned blockCol = (j + k) / _blockSizeN;
+            unsigned localCol = (j + k) % _blockSizeN;
+            unsigned len = std::min(_blockSizeN - localCol, count - k);
+            if (const T* block = blockData(blockRow, blockCol)) {
+                const T* src = block + static_cast<size_t>(localRow) * _blockSizeN + localCol;
+                std::copy(src, src + len, out + k);
+            } else {
+                std::fill(out + k, out + k + len, T());
+            }
+            k += len;
+        }
+    }
+
     // Установка блока
     void setBlock(unsigned blockRow, unsigned blockCol, std::shared_ptr<MatrixDense<T>> block) {
         if (block->rows() != _blockSizeM || block->cols() != _blockSizeN) {
             throw std::invalid_argument("Размер блока не соответствует размеру блока матрицы.");
         }
+        // В арене блок на занятом месте перезаписывается, новый - распаковывает матрицу
+        if (arena) {
+            if (arena->data(blockIndex(blockRow, blockCol))) {
+                T* data = ownArena().data(blockIndex(blockRow, blockCol));
+                const T* src = block->rowData(0);
+                std::copy(src, src + static_cast<size_t>(_blockSizeM) * _blockSizeN, data);
+                return;
+            }
+            unpack();
+        }
         blocks[blockRow][blockCol] = block;
     }
 
@@ -110,11 +319,8 @@ public:
         unsigned localRow = i % _blockSizeM;
         unsigned localCol = j % _blockSizeN;
 
-        if (blocks[blockRow][blockCol]) {
-            return (*blocks[blockRow][blockCol])(localRow, localCol);
-        } else {
-            return T();
-        }
+        const T* block = blockData(blockRow, blockCol);
+        return block ? block[static_cast<size_t>(localRow) * _blockSizeN + localCol] : T();
     }
 
     // Помощник для установки элемента
@@ -124,10 +330,16 @@ public:
         unsigned localRow = i % _blockSizeM;
         unsigned localCol = j % _blockSizeN;
 
-        if (!blocks[blockRow][blockCol]) {
-            blocks[blockRow][blockCol] = std::make_shared<MatrixDense<T>>(_blockSizeM, _blockSizeN);
+        writableBlock(blockRow, blockCol)[static_cast<size_t>(localRow) * _blockSizeN + localCol] = value;
+    }
+
+    // Плотная копия всей матрицы; отсутствующие блоки - нули
+    MatrixDense<T> toDense() const {
+        MatrixDense<T> result(rows(), cols());
+        if (rows() > 0 && cols() > 0) {
+            this->copyTile(0, 0, rows(), cols(), &result(0, 0), cols());
         }
-        (*blocks[blockRow][blockCol])(localRow, localCol) = value;
+        return result;
     }
 
     // Операции с матрицами
@@ -138,13 +350,7 @@ public:
             throw std::invalid_argument("Размеры матриц должны совпадать для сложения.");
         }
 
-        for (unsigned i = 0; i < rows(); ++i) {
-            for (unsigned j = 0; j < cols(); ++j) {
-                T value = (*this)(i, j) + other(i, j);
-                setElement(i, j, value);
-            }
-        }
-
+        combineBlocks(other, *this, BlockPattern::Union, [](T a, T b) { return a + b; });
         return *this;
     }
 
@@ -154,13 +360,7 @@ public:
             throw std::invalid_argument("Размеры матриц должны совпадать для вычитания.");
         }
 
-        for (unsigned i = 0; i < rows(); ++i) {
-            for (unsigned j = 0; j < cols(); ++j) {
-                T value = (*this)(i, j) - other(i, j);
-                setElement(i, j, value);
-            }
-        }
-
+        combineBlocks(other, *this, BlockPattern::Union, [](T a, T b) { return a - b; });
         return *this;
     }
 
@@ -192,37 +392,117 @@ public:
             throw std::invalid_argument("Внутренние размеры матриц должны совпадать для умножения.");
         }
 
-        // Для простоты вернем плотную матрицу
-        MatrixDense<T>* result = new MatrixDense<T>(rows(), other.cols());
+        // На диагональную - масштабирование столбцов блоков, результат блочный
+        if (other.structure() == MatrixStructure::Diagonal) {
+            std::vector<T> d(cols());
+            for (unsigned j = 0; j < cols(); ++j) d[j] = other(j, j);
+            return scaleCols(d.data());
+        }
+
+        // На блочную с согласованным разбиением - блочный результат
+        if (other.structure() == MatrixStructure::Block) {
+            const MatrixBlock<T>& right = static_cast<const MatrixBlock<T>&>(other);
+            if (_blockCols == right._blockRows && _blockSizeN == right._blockSizeM) {
+                return blockProduct(right);
+            }
+        }
+
+        // Иначе плотный результат: каждый непустой блок A_ik добавляет
+        // A_ik * B[k-я блочная строка] к i-й блочной строке результата
+        return denseProduct(other);
+    }
 
-        for (unsigned i = 0; i < rows(); ++i) {
-            for (unsigned j = 0; j < other.cols(); ++j) {
-                T sum = T();
-                for (unsigned k = 0; k < cols(); ++k) {
-                    sum += (*this)(i, k) * other(k, j);
+    // Блок (i, j) результата - сумма A_ik * B_kj по парам непустых блоков.
+    // Для блочной строки i обходятся только непустые A_ik и непустые B_kj
+    // в k-й блочной строке other, поэтому работа пропорциональна числу таких
+    // пар; блок, для которого пар нет, остается пустым. Блочные строки
+    // результата независимы и считаются параллельно
+    MatrixBlock<T>* blockProduct(const MatrixBlock<T>& other) const {
+        if (_blockCols != other._blockRows || _blockSizeN != other._blockSizeM) {
+            throw std::invalid_argument("Разбиения блочных матриц не согласованы для умножения.");
+        }
+        MatrixBlock<T>* result = new MatrixBlock<T>(_blockRows, other._blockCols, _blockSizeM, other._blockSizeN);
+        unsigned n = other._blockSizeN;
+        std::vector<std::vector<unsigned>> present(other._blockRows);
+        for (unsigned k = 0; k < other._blockRows; ++k) {
+            for (unsigned j = 0; j < other._blockCols; ++j) {
+                if (other.blockData(k, j)) present[k].push_back(j);
+            }
+        }
+        unsigned gemmThreads = std::max(1u, ThreadPool::shared().size() / std::max(1u, _blockRows));
+        forBlockRows(_blockRows, static_cast<size_t>(_blockSizeM) * _blockSizeN * other.cols(), [&](unsigned i) {
+            auto& row = result->blocks[i];
+            for (unsigned k = 0; k < _blockCols; ++k) {
+                const T* a = blockData(i, k);
+                if (!a) continue;
+                for (unsigned j : present[k]) {
+                    T beta = row[j] ? T(1) : T();
+                    if (!row[j]) row[j] = std::make_shared<MatrixDense<T>>(_blockSizeM, n);
+                    Gemm<T>::multiply(_blockSizeM, n, _blockSizeN, T(1), a, _blockSizeN,
+                                      other.blockData(k, j), n, beta, &(*row[j])(0, 0), n, gemmThreads);
                 }
-                result->operator()(i, j) = sum;
             }
+        });
+        result->inheritMode(*this);
+        return result;
+    }
+
+    // Плотный результат для неблочного множителя: other читается построчно один раз,
+    // пустые блоки this пропускаются
+    MatrixDense<T>* denseProduct(const Matrix<T>& other) const {
+        unsigned n = other.cols();
+        MatrixDense<T>* result = new MatrixDense<T>(rows(), n);
+        if (rows() == 0 || n == 0) return result;
+        MatrixDense<T> copy(0, 0);
+        const T* b = other.rowData(0);
+        if (other.structure() != MatrixStructure::Dense) {
+            copy = MatrixDense<T>(other.rows(), n);
+            other.copyTile(0, 0, other.rows(), n, &copy(0, 0), n);
+            b = copy.rowData(0);
         }
+        // Крупные блоки при малом числе блочных строк получают потоки внутри Gemm
+        unsigned gemmThreads = std::max(1u, ThreadPool::shared().size() / std::max(1u, _blockRows));
+        forBlockRows(_blockRows, static_cast<size_t>(_blockSizeM) * _blockSizeN * n, [&](unsigned i) {
+            T* c = &(*result)(i * _blockSizeM, 0);
+            for (unsigned k = 0; k < _blockCols; ++k) {
+                const T* a = blockData(i, k);
+                if (!a) continue;
+                Gemm<T>::multiply(_blockSizeM, n, _blockSizeN, T(1), a, _blockSizeN,
+                                  b + static_cast<size_t>(k) * _blockSizeN * n, n, T(1), c, n, gemmThreads);
+            }
+        });
         return result;
     }
 
+    // diag(d) * this: строки каждого блока умножаются на свои d, пустые блоки остаются пустыми
+    MatrixBlock<T>* scaleRows(const T* d) const override {
+        return scaleBlocks([&](unsigned bi, unsigned, unsigned r, unsigned) {
+            return d[bi * _blockSizeM + r];
+        });
+    }
+
+    // this * diag(d): столбцы каждого блока умножаются на свои d
+    MatrixBlock<T>* scaleCols(const T* d) const override {
+        return scaleBlocks([&](unsigned, unsigned bj, unsigned, unsigned c) {
+            return d[bj * _blockSizeN + c];
+        });
+    }
+
     // Почленное умножение
     Matrix<T>* elemMult(const Matrix<T>& other) const override {
         if (rows() != other.rows() || cols() != other.cols()) {
             throw std::invalid_argument("Размеры матриц должны совпадать для почленного умножения.");
         }
 
+        // Вне диагонали произведение нулевое: результат диагональный
+        if (other.structure() == MatrixStructure::Diagonal) {
+            return other.elemMult(*this);
+        }
+
         MatrixBlock<T>* result = new MatrixBlock<T>(_blockRows, _blockCols, _blockSizeM, _blockSizeN);
 
-        for (unsigned i = 0; i < rows(); ++i) {
-            for (unsigned j = 0; j < cols(); ++j) {
-                T value = (*this)(i, j) * other(i, j);
-                if (value != T()) {
-                    result->setElement(i, j, value);
-                }
-            }
-        }
+        combineBlocks(other, *result, BlockPattern::Intersection, [](T a, T b) { return a * b; });
+        result->inheritMode(*this);
         return result;
     }
 
@@ -234,18 +514,13 @@ public:
 
         MatrixBlock<T>* result = new MatrixBlock<T>(_blockRows, _blockCols, _blockSizeM, _blockSizeN);
 
-        for (unsigned i = 0; i < rows(); ++i) {
-            for (unsigned j = 0; j < cols(); ++j) {
-                T denom = other(i, j);
-                if (denom == T()) {
-                    throw std::runtime_error("Деление на ноль при почленном делении матриц.");
-                }
-                T value = (*this)(i, j) / denom;
-                if (value != T()) {
-                    result->setElement(i, j, value);
-                }
+        combineBlocks(other, *result, BlockPattern::Full, [](T a, T b) {
+            if (b == T()) {
+                throw std::runtime_error("Деление на ноль при почленном делении матриц.");
             }
-        }
+            return a / b;
+        });
+        result->inheritMode(*this);
         return result;
     }
 
@@ -255,48 +530,42 @@ public:
 
         for (unsigned i = 0; i < _blockRows; ++i) {
             for (unsigned j = 0; j < _blockCols; ++j) {
-                if (blocks[i][j]) {
-                    result->blocks[j][i] = std::shared_ptr<MatrixDense<T>>(blocks[i][j]->transpose());
+                const T* src = blockData(i, j);
+                if (!src) continue;
+                T* dst = result->writableBlock(j, i);
+                for (unsigned r = 0; r < _blockSizeM; ++r) {
+                    for (unsigned c = 0; c < _blockSizeN; ++c) {
+                        dst[static_cast<size_t>(c) * _blockSizeM + r] = src[static_cast<size_t>(r) * _blockSizeN + c];
+                    }
                 }
             }
         }
+        result->inheritMode(*this);
         return result;
     }
 
     // Импорт из файла
     void importFromFile(const std::string& filename) override {
-        std::ifstream infile(filename);
-        if (!infile) {
-            throw std::runtime_error("Не удалось открыть файл для чтения.");
-        }
-
-        std::string className;
-        std::getline(infile, className);
-
-        if (className != "MatrixBlock") {
+        TextCodec::Reader reader(filename);
+        if (reader.line() != "MatrixBlock") {
             throw std::runtime_error("Файл не содержит данные MatrixBlock.");
         }
 
-        infile >> _blockRows >> _blockCols >> _blockSizeM >> _blockSizeN;
-
-        blocks.resize(_blockRows, std::vector<std::shared_ptr<MatrixDense<T>>>(_blockCols, nullptr));
-
-        for (unsigned i = 0; i < _blockRows; ++i) {
-            for (unsigned j = 0; j < _blockCols; ++j) {
-                std::string hasBlock;
-                infile >> hasBlock;
-                if (hasBlock == "1") {
-                    blocks[i][j] = std::make_shared<MatrixDense<T>>(_blockSizeM, _blockSizeN);
-                    for (unsigned m = 0; m < _blockSizeM; ++m) {
-                        for (unsigned n = 0; n < _blockSizeN; ++n) {
-                            infile >> (*blocks[i][j])(m, n);
-                        }
-                    }
+        unsigned blockRows = reader.value<unsigned>();
+        unsigned blockCols = reader.value<unsigned>();
+        unsigned blockSizeM = reader.value<unsigned>();
+        unsigned blockSizeN = reader.value<unsigned>();
+        MatrixBlock<T> loaded(blockRows, blockCols, blockSizeM, blockSizeN);
+        size_t blockElems = static_cast<size_t>(blockSizeM) * blockSizeN;
+
+        for (unsigned i = 0; i < blockRows; ++i) {
+            for (unsigned j = 0; j < blockCols; ++j) {
+                if (reader.value<unsigned>() == 1) {
+                    reader.values(loaded.writableBlock(i, j), blockElems);
                 }
             }
         }
-
-        infile.close();
+        *this = std::move(loaded);
     }
 
     // Экспорт в файл
@@ -309,33 +578,100 @@ public:
         outfile << "MatrixBlock\n";
         outfile << _blockRows << " " << _blockCols << " " << _blockSizeM << " " << _blockSizeN << "\n";
 
-        for (unsigned i = 0; i < _blockRows; ++i) {
-            for (unsigned j = 0; j < _blockCols; ++j) {
-                if (blocks[i][j]) {
-                    outfile << "1\n";
-                    for (unsigned m = 0; m < _blockSizeM; ++m) {
-                        for (unsigned n = 0; n < _blockSizeN; ++n) {
-                            outfile << (*blocks[i][j])(m, n) << " ";
-                        }
-                        outfile << "\n";
-                    }
-                } else {
-                    outfile << "0\n";
+        // Одна "строка" печати - блок с номером index = i * blockCols + j
+        size_t blockElems = static_cast<size_t>(_blockSizeM) * _blockSizeN;
+        TextCodec::writeRows(outfile, static_cast<size_t>(_blockRows) * _blockCols, blockElems, TextCodec::Format(),
+                             [&](size_t index, TextCodec::Text& text) {
+            const T* block = blockData(static_cast<unsigned>(index / _blockCols), static_cast<unsigned>(index % _blockCols));
+            if (!block) {
+                text.put("0\n");
+                return;
+            }
+            text.put("1\n");
+            for (unsigned m = 0; m < _blockSizeM; ++m) {
+                for (unsigned n = 0; n < _blockSizeN; ++n) {
+                    text.value(block[static_cast<size_t>(m) * _blockSizeN + n]);
+                    text.put(' ');
                 }
+                text.put('\n');
             }
-        }
+        });
 
         outfile.close();
     }
 
+    // Двоичный импорт: битовая карта присутствия, затем присутствующие блоки
+    void importFromBinary(const std::string& filename) override {
+        MatrixFile::Reader reader(filename);
+        const MatrixFileHeader& h = reader.header();
+        MatrixFile::check<T>(h, static_cast<uint32_t>(MatrixStructure::Block));
+        unsigned blockRows = MatrixFile::dimension(h.params[0]), blockCols = MatrixFile::dimension(h.params[1]);
+        unsigned blockSizeM = MatrixFile::dimension(h.params[2]), blockSizeN = MatrixFile::dimension(h.params[3]);
+        if (MatrixFile::dimension(h.rows) != static_cast<uint64_t>(blockRows) * blockSizeM ||
+            MatrixFile::dimension(h.cols) != static_cast<uint64_t>(blockCols) * blockSizeN) {
+            throw std::runtime_error("Некорректный заголовок двоичного файла матрицы.");
+        }
+
+        // Битовая карта читается до создания матрицы: ее длина в файле
+        // ограничивает число блоков, а каждый блок проверяется перед чтением
+        size_t blockCount = static_cast<size_t>(blockRows) * blockCols;
+        size_t blockElems = static_cast<size_t>(blockSizeM) * blockSizeN;
+        std::vector<uint64_t> present(reader.expect<uint64_t>((static_cast<uint64_t>(blockCount) + 63) / 64));
+        reader.section(present.data(), present.size());
+
+        MatrixBlock<T> loaded(blockRows, blockCols, blockSizeM, blockSizeN);
+        for (size_t index = 0; index < blockCount; ++index) {
+            if ((present[index / 64] >> (index % 64)) & 1) {
+                unsigned bi = static_cast<unsigned>(index / loaded._blockCols);
+                unsigned bj = static_cast<unsigned>(index % loaded._blockCols);
+                reader.expect<T>(blockElems);
+                reader.section(loaded.writableBlock(bi, bj), blockElems);
+            }
+        }
+        *this = std::move(loaded);
+    }
+
+    // Двоичный экспорт; params - число и размеры блоков
+    void exportToBinary(const std::string& filename) const override {
+        MatrixFileHeader h = MatrixFile::header<T>(static_cast<uint32_t>(MatrixStructure::Block), rows(), cols());
+        h.params[0] = _blockRows;
+        h.params[1] = _blockCols;
+        h.params[2] = _blockSizeM;
+        h.params[3] = _blockSizeN;
+        MatrixFile::Writer writer(filename, h);
+
+        size_t blockCount = static_cast<size_t>(_blockRows) * _blockCols;
+        size_t blockElems = static_cast<size_t>(_blockSizeM) * _blockSizeN;
+        std::vector<uint64_t> present((blockCount + 63) / 64, 0);
+        for (size_t index = 0; index < blockCount; ++index) {
+            if (blockData(static_cast<unsigned>(index / _blockCols), static_cast<unsigned>(index % _blockCols))) {
+                present[index / 64] |= uint64_t(1) << (index % 64);
+            }
+        }
+        writer.section(present.data(), present.size());
+        for (unsigned bi = 0; bi < _blockRows; ++bi) {
+            for (unsigned bj = 0; bj < _blockCols; ++bj) {
+                if (const T* block = blockData(bi, bj)) writer.section(block, blockElems);
+            }
+        }
+        writer.close();
+    }
+
     // Метод для печати матрицы
 void print(std::ostream& os = std::cout) const override {
-    for (unsigned i = 0; i < rows(); ++i) {
-        for (unsigned j = 0; j < cols(); ++j) {
-            os << (*this)(i, j) << "\t";
+    // Строка матрицы собирается из строк блоков, отсутствующие блоки - нули
+    TextCodec::writeRows(os, rows(), cols(), TextCodec::Format::of(os), [&](size_t i, TextCodec::Text& text) {
+        unsigned bi = static_cast<unsigned>(i / _blockSizeM);
+        size_t localRow = i % _blockSizeM;
+        for (unsigned bj = 0; bj < _blockCols; ++bj) {
+            const T* block = blockData(bi, bj);
+            for (unsigned n = 0; n < _blockSizeN; ++n) {
+                text.value(block ? block[localRow * _blockSizeN + n] : T());
+                text.put('\t');
+            }
         }
-        os << "\n";
-    }
+        text.put('\n');
+    });
 }
 };
 
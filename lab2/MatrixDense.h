@@ -4,48 +4,97 @@
 #define MATRIXDENSE_H
 
 #include "Matrix.h"
+#include "Gemm.h"
+#include "ThreadPool.h"
+#include "MatrixExpr.h"
+#include "Strassen.h"
+#include "Transpose.h"
+#include "MatrixFile.h"
+#include "TextCodec.h"
 #include <fstream>
 #include <iostream>
 #include <stdexcept>
 #include <algorithm>
+#include <memory>
+#include <vector>
 
 template <typename T = double>
 class MatrixDense : public Matrix<T> {
 private:
     unsigned _m, _n;
     T* data;
+    std::shared_ptr<void> mapping;    // Отображенный файл, если data указывает в него (mapFile)
+
+    size_t size() const { return static_cast<size_t>(_m) * _n; }
+
+    // Освобождение хранилища: своя память удаляется, отображение отпускается
+    void release() {
+        if (!mapping) delete[] data;
+        mapping.reset();
+        data = nullptr;
+    }
+
+    // out(i, j) = op(this(i, j), other(i, j)) по строкам: строка other читается
+    // одним вызовом readRow, внутренний цикл идет по непрерывной памяти.
+    // out может совпадать с *this
+    template <typename Op>
+    void combineRows(const Matrix<T>& other, MatrixDense<T>& out, Op op) const {
+        std::vector<T> buffer(other.structure() == MatrixStructure::Dense ? 0 : _n);
+        for (unsigned i = 0; i < _m; ++i) {
+            const T* src = other.readRow(i, buffer.data());
+            const T* row = data + static_cast<size_t>(i) * _n;
+            T* dst = out.data + static_cast<size_t>(i) * _n;
+            for (unsigned j = 0; j < _n; ++j) {
+                dst[j] = op(row[j], src[j]);
+            }
+        }
+    }
+
+    // func(i, строка this, строка out) для всех строк, полосами в общем пуле потоков
+    template <typename Func>
+    void forRowStrips(Func func, MatrixDense<T>& out) const {
+        const unsigned rowsPerTask = 64;
+        unsigned tasks = (_m + rowsPerTask - 1) / rowsPerTask;
+        ThreadPool::shared().parallelFor(tasks, 0, [&](unsigned t) {
+            unsigned end = std::min(_m, (t + 1) * rowsPerTask);
+            for (unsigned i = t * rowsPerTask; i < end; ++i) {
+                func(i, data + static_cast<size_t>(i) * _n, out.data + static_cast<size_t>(i) * _n);
+            }
+        });
+    }
 
 public:
     // Конструктор
     MatrixDense(unsigned m, unsigned n) : _m(m), _n(n) {
-        data = new T[_m * _n]();
+        data = new T[size()]();
     }
 
-    // Конструктор копирования
+    // Конструктор копирования; копия отображенной матрицы - в обычной памяти
     MatrixDense(const MatrixDense<T>& other) : _m(other._m), _n(other._n) {
-        data = new T[_m * _n];
-        std::copy(other.data, other.data + _m * _n, data);
+        data = new T[size()];
+        std::copy(other.data, other.data + size(), data);
     }
 
     // Конструктор перемещения
-    MatrixDense(MatrixDense<T>&& other) noexcept : _m(other._m), _n(other._n), data(other.data) {
+    MatrixDense(MatrixDense<T>&& other) noexcept
+        : _m(other._m), _n(other._n), data(other.data), mapping(std::move(other.mapping)) {
         other.data = nullptr;
         other._m = other._n = 0;
     }
 
     // Деструктор
     ~MatrixDense() {
-        delete[] data;
+        release();
     }
 
     // Оператор присваивания
     MatrixDense<T>& operator=(const MatrixDense<T>& other) {
         if (this != &other) {
-            delete[] data;
+            release();
             _m = other._m;
             _n = other._n;
-            data = new T[_m * _n];
-            std::copy(other.data, other.data + _m * _n, data);
+            data = new T[size()];
+            std::copy(other.data, other.data + size(), data);
         }
         return *this;
     }
@@ -53,26 +102,78 @@ public:
     // Оператор перемещающего присваивания
     MatrixDense<T>& operator=(MatrixDense<T>&& other) noexcept {
         if (this != &other) {
-            delete[] data;
+            release();
             _m = other._m;
             _n = other._n;
             data = other.data;
+            mapping = std::move(other.mapping);
             other.data = nullptr;
             other._m = other._n = 0;
         }
         return *this;
     }
 
+    // Матрица только для чтения прямо над отображенным в память двоичным файлом
+    // (exportToBinary): загрузка не читает и не копирует данные, страницы
+    // подгружаются при обращении. Страницы отображены без права записи, поэтому
+    // матрица константная; копия (MatrixDense<T> copy = *view) - в обычной памяти
+    static std::shared_ptr<const MatrixDense<T>> mapFile(const std::string& filename) {
+        auto file = std::make_shared<MatrixFile::Mapping>(filename);
+        const MatrixFileHeader& h = file->header();
+        MatrixFile::check<T>(h, static_cast<uint32_t>(MatrixStructure::Dense));
+        unsigned m = MatrixFile::dimension(h.rows);
+        unsigned n = MatrixFile::dimension(h.cols);
+        if (h.dataOffset % alignof(T) != 0) {
+            throw std::runtime_error("Некорректный заголовок двоичного файла матрицы.");
+        }
+        if (MatrixFile::sectionEnd(h.dataOffset, static_cast<uint64_t>(m) * n, sizeof(T)) > file->size()) {
+            throw std::runtime_error("Двоичный файл матрицы обрезан.");
+        }
+        auto view = std::make_shared<MatrixDense<T>>(0, 0);
+        view->release();
+        view->_m = m;
+        view->_n = n;
+        // Снятие const безопасно: наружу матрица отдается только константной
+        view->data = const_cast<T*>(reinterpret_cast<const T*>(file->data() + h.dataOffset));
+        view->mapping = std::move(file);
+        return view;
+    }
+
+    bool mapped() const { return mapping != nullptr; }
+
     unsigned rows() const override { return _m; }
     unsigned cols() const override { return _n; }
 
+    MatrixStructure structure() const override { return MatrixStructure::Dense; }
+
+    const T* rowData(unsigned i) const override {
+        return data + static_cast<size_t>(i) * _n;
+    }
+
+    void copyRow(unsigned i, unsigned j, unsigned count, T* out) const override {
+        const T* row = data + static_cast<size_t>(i) * _n + j;
+        std::copy(row, row + count, out);
+    }
+
     // Доступ к элементам
     T& operator()(unsigned i, unsigned j) {
-        return data[i * _n + j];
+        return data[static_cast<size_t>(i) * _n + j];
     }
 
     T operator()(unsigned i, unsigned j) const override {
-        return data[i * _n + j];
+        return data[static_cast<size_t>(i) * _n + j];
+    }
+
+    // Лист ленивого выражения (MatrixExpr.h)
+    MatRef<T> expr() const {
+        return MatRef<T>{data, _m, _n};
+    }
+
+    // Вычисление выражения в эту матрицу за один проход
+    template <MatExpression E>
+    MatrixDense<T>& assign(const E& e, unsigned numThreads = 0) {
+        MatrixOps::assign(*this, e, numThreads);
+        return *this;
     }
 
     // Операции с матрицами
@@ -81,11 +182,7 @@ public:
             throw std::invalid_argument("Размеры матриц должны совпадать для сложения.");
         }
 
-        for (unsigned i = 0; i < _m; ++i) {
-            for (unsigned j = 0; j < _n; ++j) {
-                (*this)(i, j) += other(i, j);
-            }
-        }
+        combineRows(other, *this, [](T a, T b) { return a + b; });
         return *this;
     }
 
@@ -94,11 +191,7 @@ public:
             throw std::invalid_argument("Размеры матриц должны совпадать для вычитания.");
         }
 
-        for (unsigned i = 0; i < _m; ++i) {
-            for (unsigned j = 0; j < _n; ++j) {
-                (*this)(i, j) -= other(i, j);
-            }
-        }
+        combineRows(other, *this, [](T a, T b) { return a - b; });
         return *this;
     }
 
@@ -110,11 +203,7 @@ public:
 
         MatrixDense<T>* result = new MatrixDense<T>(_m, _n);
 
-        for (unsigned i = 0; i < _m; ++i) {
-            for (unsigned j = 0; j < _n; ++j) {
-                result->operator()(i, j) = (*this)(i, j) + other(i, j);
-            }
-        }
+        combineRows(other, *result, [](T a, T b) { return a + b; });
         return result;
     }
 
@@ -126,11 +215,7 @@ public:
 
         MatrixDense<T>* result = new MatrixDense<T>(_m, _n);
 
-        for (unsigned i = 0; i < _m; ++i) {
-            for (unsigned j = 0; j < _n; ++j) {
-                result->operator()(i, j) = (*this)(i, j) - other(i, j);
-            }
-        }
+        combineRows(other, *result, [](T a, T b) { return a - b; });
         return result;
     }
 
@@ -140,17 +225,57 @@ public:
             throw std::invalid_argument("Внутренние размеры матриц должны совпадать для умножения.");
         }
 
-        MatrixDense<T>* result = new MatrixDense<T>(_m, other.cols());
+        // Умножение на диагональную - масштабирование столбцов за O(m*n)
+        if (other.structure() == MatrixStructure::Diagonal) {
+            std::vector<T> d(_n);
+            for (unsigned j = 0; j < _n; ++j) d[j] = other(j, j);
+            return scaleCols(d.data());
+        }
 
-        for (unsigned i = 0; i < _m; ++i) {
-            for (unsigned j = 0; j < other.cols(); ++j) {
-                T sum = T();
-                for (unsigned k = 0; k < _n; ++k) {
-                    sum += (*this)(i, k) * other(k, j);
-                }
-                (*result)(i, j) = sum;
-            }
+        unsigned n = other.cols();
+        MatrixDense<T>* result = new MatrixDense<T>(_m, n);
+
+        // Правый множитель нужен в построчном хранении: плотный берется как есть,
+        // остальные один раз копируются плиткой целиком
+        const MatrixDense<T>* dense = other.structure() == MatrixStructure::Dense
+            ? static_cast<const MatrixDense<T>*>(&other) : nullptr;
+        MatrixDense<T> copy(0, 0);
+        if (!dense) {
+            copy = MatrixDense<T>(_n, n);
+            other.copyTile(0, 0, _n, n, copy.data, n);
+            dense = &copy;
         }
+
+        Gemm<T>::multiply(_m, n, _n, T(1), data, _n, dense->data, n, T(), result->data, n);
+        return result;
+    }
+
+    MatrixDense<T>* scaleRows(const T* d) const override {
+        MatrixDense<T>* result = new MatrixDense<T>(_m, _n);
+        forRowStrips([&](unsigned i, const T* row, T* dst) {
+            for (unsigned j = 0; j < _n; ++j) dst[j] = d[i] * row[j];
+        }, *result);
+        return result;
+    }
+
+    MatrixDense<T>* scaleCols(const T* d) const override {
+        MatrixDense<T>* result = new MatrixDense<T>(_m, _n);
+        forRowStrips([&](unsigned, const T* row, T* dst) {
+            for (unsigned j = 0; j < _n; ++j) dst[j] = row[j] * d[j];
+        }, *result);
+        return result;
+    }
+
+    // Умножение по Штрассену-Винограду для квадратных матриц одного размера.
+    // Включается явно: быстрее operator* на больших размерах, но с большей
+    // погрешностью (оценка в Strassen.h)
+    MatrixDense<T>* strassenProduct(const MatrixDense<T>& other, unsigned numThreads = 0) const {
+        if (_m != _n || other._m != other._n || _n != other._m) {
+            throw std::invalid_argument("Умножение по Штрассену определено для квадратных матриц одного размера.");
+        }
+
+        MatrixDense<T>* result = new MatrixDense<T>(_m, _m);
+        Strassen<T>::multiply(_m, data, _n, other.data, other._n, result->data, _m, numThreads);
         return result;
     }
 
@@ -159,14 +284,14 @@ public:
         if (_m != other.rows() || _n != other.cols()) {
             throw std::invalid_argument("Размеры матриц должны совпадать для почленного умножения.");
         }
+        // Вне диагонали произведение нулевое: результат диагональный
+        if (other.structure() == MatrixStructure::Diagonal) {
+            return other.elemMult(*this);
+        }
 
         MatrixDense<T>* result = new MatrixDense<T>(_m, _n);
 
-        for (unsigned i = 0; i < _m; ++i) {
-            for (unsigned j = 0; j < _n; ++j) {
-                result->operator()(i, j) = (*this)(i, j) * other(i, j);
-            }
-        }
+        combineRows(other, *result, [](T a, T b) { return a * b; });
         return result;
     }
 
@@ -178,30 +303,35 @@ public:
 
         MatrixDense<T>* result = new MatrixDense<T>(_m, _n);
 
-        for (unsigned i = 0; i < _m; ++i) {
-            for (unsigned j = 0; j < _n; ++j) {
-                if (other(i, j) == T()) {
-                    throw std::runtime_error("Деление на ноль при почленном делении матриц.");
-                }
-                result->operator()(i, j) = (*this)(i, j) / other(i, j);
+        combineRows(other, *result, [](T a, T b) {
+            if (b == T()) {
+                throw std::runtime_error("Деление на ноль при почленном делении матриц.");
             }
-        }
+            return a / b;
+        });
         return result;
     }
 
     // Транспонирование
     MatrixDense<T>* transpose() const override {
         MatrixDense<T>* result = new MatrixDense<T>(_n, _m);
+        Transpose<T>::outOfPlace(_m, _n, data, _n, result->data, _m);
+        return result;
+    }
 
-        for (unsigned i = 0; i < _m; ++i) {
-            for (unsigned j = 0; j < _n; ++j) {
-                result->operator()(j, i) = (*this)(i, j);
-            }
+    // Транспонирование без второй матрицы: квадратная - обменом плиток в потоках
+    // общего пула, прямоугольная - обходом циклов перестановки (последовательно)
+    void transposeInPlace(unsigned numThreads = 0) {
+        if (_m == _n) {
+            Transpose<T>::inPlaceSquare(_n, data, _n, numThreads);
+        } else {
+            Transpose<T>::inPlaceCycles(_m, _n, data);
+            std::swap(_m, _n);
         }
-        return result;
     }
 
-    // Произведение Кронекера
+    // Произведение Кронекера. Материализует все (m p) x (n q) элементов; для умножения
+    // на векторы без построения матрицы - ленивое MatrixKronecker
     MatrixDense<T>* kroneckerProduct(const MatrixDense<T>& other) const {
         unsigned m = _m * other.rows();
         unsigned n = _n * other.cols();
@@ -222,33 +352,17 @@ public:
 
     // Импорт из файла
     void importFromFile(const std::string& filename) override {
-        std::ifstream infile(filename);
-        if (!infile) {
-            throw std::runtime_error("Не удалось открыть файл для чтения.");
-        }
-
-        std::string className;
-        std::getline(infile, className);
-
-        if (className != "MatrixDense") {
+        TextCodec::Reader reader(filename);
+        if (reader.line() != "MatrixDense") {
             throw std::runtime_error("Файл не содержит данные MatrixDense.");
         }
 
-        unsigned m, n;
-        infile >> m >> n;
-
-        delete[] data;
-        _m = m;
-        _n = n;
-        data = new T[_m * _n];
+        unsigned m = reader.value<unsigned>();
+        unsigned n = reader.value<unsigned>();
 
-        for (unsigned i = 0; i < _m; ++i) {
-            for (unsigned j = 0; j < _n; ++j) {
-                infile >> (*this)(i, j);
-            }
-        }
-
-        infile.close();
+        MatrixDense<T> loaded(m, n);
+        reader.values(loaded.data, loaded.size());
+        *this = std::move(loaded);
     }
 
     // Экспорт в файл
@@ -261,24 +375,48 @@ public:
         outfile << "MatrixDense\n";
         outfile << _m << " " << _n << "\n";
 
-        for (unsigned i = 0; i < _m; ++i) {
+        TextCodec::writeRows(outfile, _m, _n, TextCodec::Format(), [&](size_t i, TextCodec::Text& text) {
             for (unsigned j = 0; j < _n; ++j) {
-                outfile << (*this)(i, j) << " ";
+                text.value(data[i * _n + j]);
+                text.put(' ');
             }
-            outfile << "\n";
-        }
+            text.put('\n');
+        });
 
         outfile.close();
     }
 
+    // Двоичный импорт: данные читаются одним read в новую память
+    void importFromBinary(const std::string& filename) override {
+        MatrixFile::Reader reader(filename);
+        const MatrixFileHeader& h = reader.header();
+        MatrixFile::check<T>(h, static_cast<uint32_t>(MatrixStructure::Dense));
+
+        unsigned m = MatrixFile::dimension(h.rows);
+        unsigned n = MatrixFile::dimension(h.cols);
+        reader.expect<T>(static_cast<uint64_t>(m) * n);
+
+        MatrixDense<T> loaded(m, n);
+        reader.section(loaded.data, loaded.size());
+        *this = std::move(loaded);
+    }
+
+    // Двоичный экспорт: заголовок и все элементы построчно одним блоком
+    void exportToBinary(const std::string& filename) const override {
+        MatrixFile::Writer writer(filename, MatrixFile::header<T>(static_cast<uint32_t>(MatrixStructure::Dense), _m, _n));
+        writer.section(data, size());
+        writer.close();
+    }
+
     // Метод для печати матрицы
 void print(std::ostream& os = std::cout) const override {
-    for (unsigned i = 0; i < _m; ++i) {
+    TextCodec::writeRows(os, _m, _n, TextCodec::Format::of(os), [&](size_t i, TextCodec::Text& text) {
         for (unsigned j = 0; j < _n; ++j) {
-            os << (*this)(i, j) << "\t";
+            text.value(data[i * _n + j]);
+            text.put('\t');
         }
-        os << "\n";
-    }
+        text.put('\n');
+    });
 }
 };
 
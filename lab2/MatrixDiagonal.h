@@ -4,10 +4,15 @@
 #define MATRIXDIAGONAL_H
 
 #include "Matrix.h"
+#include "MatrixExpr.h"
+#include "MatrixFile.h"
+#include "TextCodec.h"
+#include "ThreadPool.h"
 #include <fstream>
 #include <iostream>
 #include <stdexcept>
 #include <algorithm>
+#include <vector>
 
 template <typename T = double>
 class MatrixDiagonal : public Matrix<T> {
@@ -15,6 +20,22 @@ private:
     unsigned _size;
     T* data; // Хранит диагональные элементы
 
+    // Сумма с недиагональной матрицей уже не диагональная:
+    // плотный результат this + sign * other
+    MatrixDense<T>* sumDense(const Matrix<T>& other, T sign) const {
+        MatrixDense<T>* result = new MatrixDense<T>(_size, _size);
+        if (_size == 0) return result;
+        other.copyTile(0, 0, _size, _size, &result->operator()(0, 0), _size);
+        for (unsigned i = 0; i < _size; ++i) {
+            T* row = &result->operator()(i, 0);
+            if (sign != T(1)) {
+                for (unsigned j = 0; j < _size; ++j) row[j] = sign * row[j];
+            }
+            row[i] += data[i];
+        }
+        return result;
+    }
+
 public:
     // Конструктор
     MatrixDiagonal(unsigned size) : _size(size) {
@@ -64,6 +85,13 @@ public:
     unsigned rows() const override { return _size; }
     unsigned cols() const override { return _size; }
 
+    MatrixStructure structure() const override { return MatrixStructure::Diagonal; }
+
+    void copyRow(unsigned i, unsigned j, unsigned count, T* out) const override {
+        std::fill(out, out + count, T());
+        if (i >= j && i < j + count) out[i - j] = data[i];
+    }
+
     // Доступ к элементам
     T& operator()(unsigned i, unsigned j) {
         static T zero = T();
@@ -79,6 +107,11 @@ public:
         return data[i];
     }
 
+    // Лист ленивого выражения (MatrixExpr.h)
+    MatDiag<T> expr() const {
+        return MatDiag<T>{data, _size};
+    }
+
 
 
     // Сложение
@@ -111,6 +144,9 @@ public:
             throw std::invalid_argument("Размеры матриц должны совпадать для сложения.");
         }
 
+        if (other.structure() != MatrixStructure::Diagonal) {
+            return sumDense(other, T(1));
+        }
         MatrixDiagonal<T>* result = new MatrixDiagonal<T>(*this);
         result->operator+=(other);
         return result;
@@ -122,6 +158,9 @@ public:
             throw std::invalid_argument("Размеры матриц должны совпадать для вычитания.");
         }
 
+        if (other.structure() != MatrixStructure::Diagonal) {
+            return sumDense(other, T(-1));
+        }
         MatrixDiagonal<T>* result = new MatrixDiagonal<T>(*this);
         result->operator-=(other);
         return result;
@@ -133,13 +172,41 @@ public:
             throw std::invalid_argument("Внутренние размеры матриц должны совпадать для умножения.");
         }
 
-        MatrixDense<T>* result = new MatrixDense<T>(_size, other.cols());
+        // Произведение - масштабирование строк other; структура other сохраняется:
+        // диагональная дает диагональную, блочная - блочную, плотная - плотную
+        if (Matrix<T>* scaled = other.scaleRows(data)) {
+            return scaled;
+        }
 
-        for (unsigned i = 0; i < _size; ++i) {
-            for (unsigned j = 0; j < other.cols(); ++j) {
-                result->operator()(i, j) = data[i] * other(i, j);
+        unsigned n = other.cols();
+        MatrixDense<T>* result = new MatrixDense<T>(_size, n);
+
+        // Общий случай: полосы строк раздаются потокам общего пула
+        const unsigned rowsPerTask = 64;
+        unsigned tasks = (_size + rowsPerTask - 1) / rowsPerTask;
+        ThreadPool::shared().parallelFor(tasks, 0, [&](unsigned t) {
+            std::vector<T> buffer(other.structure() == MatrixStructure::Dense ? 0 : n);
+            unsigned end = std::min(_size, (t + 1) * rowsPerTask);
+            for (unsigned i = t * rowsPerTask; i < end; ++i) {
+                const T* src = other.readRow(i, buffer.data());
+                T* dst = &result->operator()(i, 0);
+                for (unsigned j = 0; j < n; ++j) {
+                    dst[j] = data[i] * src[j];
+                }
             }
-        }
+        });
+        return result;
+    }
+
+    MatrixDiagonal<T>* scaleRows(const T* d) const override {
+        MatrixDiagonal<T>* result = new MatrixDiagonal<T>(_size);
+        for (unsigned i = 0; i < _size; ++i) result->data[i] = d[i] * data[i];
+        return result;
+    }
+
+    MatrixDiagonal<T>* scaleCols(const T* d) const override {
+        MatrixDiagonal<T>* result = new MatrixDiagonal<T>(_size);
+        for (unsigned i = 0; i < _size; ++i) result->data[i] = data[i] * d[i];
         return result;
     }
 
@@ -182,30 +249,14 @@ public:
 
     // Импорт из файла
     void importFromFile(const std::string& filename) override {
-        std::ifstream infile(filename);
-        if (!infile) {
-            throw std::runtime_error("Не удалось открыть файл для чтения.");
-        }
-
-        std::string className;
-        std::getline(infile, className);
-
-        if (className != "MatrixDiagonal") {
+        TextCodec::Reader reader(filename);
+        if (reader.line() != "MatrixDiagonal") {
             throw std::runtime_error("Файл не содержит данные MatrixDiagonal.");
         }
 
-        unsigned size;
-        infile >> size;
-
-        delete[] data;
-        _size = size;
-        data = new T[_size];
-
-        for (unsigned i = 0; i < _size; ++i) {
-            infile >> data[i];
-        }
-
-        infile.close();
+        MatrixDiagonal<T> loaded(reader.value<unsigned>());
+        reader.values(loaded.data, loaded._size);
+        *this = std::move(loaded);
     }
 
     // Экспорт в файл
@@ -218,25 +269,53 @@ public:
         outfile << "MatrixDiagonal\n";
         outfile << _size << "\n";
 
-        for (unsigned i = 0; i < _size; ++i) {
-            outfile << data[i] << " ";
-        }
+        // Вся диагональ - одна строка, задания печатают ее по кускам
+        TextCodec::writeRows(outfile, _size, 1, TextCodec::Format(), [&](size_t i, TextCodec::Text& text) {
+            text.value(data[i]);
+            text.put(' ');
+        });
         outfile << "\n";
 
         outfile.close();
     }
 
+    // Двоичный импорт: один раздел с элементами диагонали
+    void importFromBinary(const std::string& filename) override {
+        MatrixFile::Reader reader(filename);
+        const MatrixFileHeader& h = reader.header();
+        MatrixFile::check<T>(h, static_cast<uint32_t>(MatrixStructure::Diagonal));
+        if (h.rows != h.cols) {
+            throw std::runtime_error("Некорректный заголовок двоичного файла матрицы.");
+        }
+
+        unsigned n = MatrixFile::dimension(h.rows);
+        reader.expect<T>(n);
+
+        MatrixDiagonal<T> loaded(n);
+        reader.section(loaded.data, loaded._size);
+        *this = std::move(loaded);
+    }
+
+    // Двоичный экспорт
+    void exportToBinary(const std::string& filename) const override {
+        MatrixFile::Writer writer(filename, MatrixFile::header<T>(static_cast<uint32_t>(MatrixStructure::Diagonal), _size, _size));
+        writer.section(data, _size);
+        writer.close();
+    }
+
     // Метод для печати матрицы
 void print(std::ostream& os = std::cout) const override {
-    for (unsigned i = 0; i < _size; ++i) {
+    TextCodec::writeRows(os, _size, _size, TextCodec::Format::of(os), [&](size_t i, TextCodec::Text& text) {
         for (unsigned j = 0; j < _size; ++j) {
-            if (i == j)
-                os << data[i] << "\t";
-            else
-                os << "0\t";
+            if (i == j) {
+                text.value(data[i]);
+                text.put('\t');
+            } else {
+                text.put("0\t");
+            }
         }
-        os << "\n";
-    }
+        text.put('\n');
+    });
 }
 };
 
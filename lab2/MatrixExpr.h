@@ -0,0 +1,220 @@
+#ifndef MATRIXEXPR_H
+#define MATRIXEXPR_H
+
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+
+#include "Matrix.h"
+#include "ThreadPool.h"
+
+template <typename T> class MatrixDense;
+
+// Ленивая поэлементная алгебра матриц. Выражение вида
+// A.expr() + B.expr() - MatrixOps::elemMult(C.expr(), D.expr())
+// не создает промежуточных матриц, а строит дерево узлов; MatrixOps::assign
+// вычисляет его в матрицу-приемник одним проходом по строкам, без выделений памяти.
+// Листья плотных и диагональных матриц читают память напрямую, поэтому внутренний
+// цикл по строке векторизуется; остальные матрицы подключаются через MatrixOps::ref
+// с виртуальным доступом к элементам.
+
+// Лист: плотная матрица в построчном хранении
+template <typename T>
+struct MatRef {
+    using value_type = T;
+    const T* data;
+    unsigned m, n;
+
+    unsigned rows() const { return m; }
+    unsigned cols() const { return n; }
+    T operator()(unsigned i, unsigned j) const { return data[static_cast<size_t>(i) * n + j]; }
+};
+
+// Лист: диагональная матрица
+template <typename T>
+struct MatDiag {
+    using value_type = T;
+    const T* data;
+    unsigned size;
+
+    unsigned rows() const { return size; }
+    unsigned cols() const { return size; }
+    T operator()(unsigned i, unsigned j) const { return i == j ? data[i] : T(); }
+};
+
+// Лист: произвольная матрица через виртуальный operator()
+template <typename T>
+struct MatAny {
+    using value_type = T;
+    const Matrix<T>* matrix;
+
+    unsigned rows() const { return matrix->rows(); }
+    unsigned cols() const { return matrix->cols(); }
+    T operator()(unsigned i, unsigned j) const { return (*matrix)(i, j); }
+};
+
+// Лист: скаляр, одинаковый для всех элементов; размер берется у другого операнда
+template <typename T>
+struct MatScalar {
+    using value_type = T;
+    T value;
+
+    T operator()(unsigned, unsigned) const { return value; }
+};
+
+template <typename L, typename R, typename Op>
+struct MatBinary {
+    using value_type = std::common_type_t<typename L::value_type, typename R::value_type>;
+    L left;
+    R right;
+
+    unsigned rows() const { return sizeOf().rows(); }
+    unsigned cols() const { return sizeOf().cols(); }
+    value_type operator()(unsigned i, unsigned j) const { return Op::apply(left(i, j), right(i, j)); }
+
+private:
+    const auto& sizeOf() const {
+        if constexpr (std::is_same_v<L, MatScalar<typename L::value_type>>) {
+            return right;
+        } else {
+            return left;
+        }
+    }
+};
+
+template <typename E, typename Op>
+struct MatUnary {
+    using value_type = typename E::value_type;
+    E expr;
+    Op op;
+
+    unsigned rows() const { return expr.rows(); }
+    unsigned cols() const { return expr.cols(); }
+    value_type operator()(unsigned i, unsigned j) const { return op(expr(i, j)); }
+};
+
+template <typename E> struct IsMatExpr : std::false_type {};
+template <typename T> struct IsMatExpr<MatRef<T>> : std::true_type {};
+template <typename T> struct IsMatExpr<MatDiag<T>> : std::true_type {};
+template <typename T> struct IsMatExpr<MatAny<T>> : std::true_type {};
+template <typename T> struct IsMatExpr<MatScalar<T>> : std::true_type {};
+template <typename L, typename R, typename Op> struct IsMatExpr<MatBinary<L, R, Op>> : std::true_type {};
+template <typename E, typename Op> struct IsMatExpr<MatUnary<E, Op>> : std::true_type {};
+
+template <typename E>
+concept MatExpression = IsMatExpr<std::remove_cvref_t<E>>::value;
+
+struct MatAdd { template <typename A, typename B> static auto apply(A a, B b) { return a + b; } };
+struct MatSub { template <typename A, typename B> static auto apply(A a, B b) { return a - b; } };
+struct MatMul { template <typename A, typename B> static auto apply(A a, B b) { return a * b; } };
+
+// Почленное деление с той же проверкой, что и у Matrix::elemDiv
+struct MatDiv {
+    template <typename A, typename B>
+    static auto apply(A a, B b) {
+        if (b == B()) {
+            throw std::runtime_error("Деление на ноль при почленном делении матриц.");
+        }
+        return a / b;
+    }
+};
+
+template <typename L, typename R>
+concept MatOperands = (MatExpression<L> || MatExpression<R>) &&
+                      (MatExpression<L> || std::is_arithmetic_v<L>) &&
+                      (MatExpression<R> || std::is_arithmetic_v<R>);
+
+// Узел бинарной операции; скаляр приводится к типу элементов другого операнда,
+// размеры двух матричных операндов проверяются при построении
+template <typename Op, typename L, typename R>
+auto makeMatBinary(const L& left, const R& right) {
+    if constexpr (!MatExpression<L>) {
+        using T = typename R::value_type;
+        return MatBinary<MatScalar<T>, R, Op>{MatScalar<T>{static_cast<T>(left)}, right};
+    } else if constexpr (!MatExpression<R>) {
+        using T = typename L::value_type;
+        return MatBinary<L, MatScalar<T>, Op>{left, MatScalar<T>{static_cast<T>(right)}};
+    } else {
+        if (left.rows() != right.rows() || left.cols() != right.cols()) {
+            throw std::invalid_argument("Размеры матриц должны совпадать для поэлементной операции.");
+        }
+        return MatBinary<L, R, Op>{left, right};
+    }
+}
+
+template <typename L, typename R> requires MatOperands<L, R>
+auto operator+(const L& left, const R& right) {
+    return makeMatBinary<MatAdd>(left, right);
+}
+
+template <typename L, typename R> requires MatOperands<L, R>
+auto operator-(const L& left, const R& right) {
+    return makeMatBinary<MatSub>(left, right);
+}
+
+// Только умножение на скаляр: произведение двух выражений было бы неоднозначно
+// (матричное или почленное), для почленного есть MatrixOps::elemMult
+template <typename L, typename R>
+    requires MatOperands<L, R> && (!MatExpression<L> || !MatExpression<R>)
+auto operator*(const L& left, const R& right) {
+    return makeMatBinary<MatMul>(left, right);
+}
+
+struct MatrixOps {
+
+    template <typename T>
+    static MatAny<T> ref(const Matrix<T>& matrix) { return MatAny<T>{&matrix}; }
+
+    template <MatExpression L, MatExpression R>
+    static auto elemMult(const L& left, const R& right) {
+        return makeMatBinary<MatMul>(left, right);
+    }
+
+    template <MatExpression L, MatExpression R>
+    static auto elemDiv(const L& left, const R& right) {
+        return makeMatBinary<MatDiv>(left, right);
+    }
+
+    template <MatExpression E>
+    static auto abs(const E& expr) {
+        using T = typename E::value_type;
+        auto op = [](T v) { return v < T() ? -v : v; };
+        return MatUnary<E, decltype(op)>{expr, op};
+    }
+
+    // Вычисление выражения в dst за один проход, полосами строк в общем пуле потоков
+    // (numThreads = 0 - все потоки). dst может быть листом выражения: элемент (i, j)
+    // зависит только от элементов (i, j) операндов.
+    template <typename T, MatExpression E>
+    static void assign(MatrixDense<T>& dst, const E& expr, unsigned numThreads = 0) {
+        unsigned m = expr.rows();
+        unsigned n = expr.cols();
+        if (dst.rows() != m || dst.cols() != n) {
+            throw std::invalid_argument("Размеры матрицы-приемника не совпадают с размерами выражения.");
+        }
+        if (m == 0 || n == 0) return;
+
+        // Полоса - около 16K элементов, чтобы задание окупало раздачу
+        unsigned rowsPerTask = std::max(1u, (1u << 14) / n);
+        unsigned tasks = (m + rowsPerTask - 1) / rowsPerTask;
+        ThreadPool::shared().parallelFor(tasks, numThreads, [&](unsigned t) {
+            unsigned end = std::min(m, (t + 1) * rowsPerTask);
+            for (unsigned i = t * rowsPerTask; i < end; ++i) {
+                T* row = &dst(i, 0);
+                for (unsigned j = 0; j < n; ++j) {
+                    row[j] = static_cast<T>(expr(i, j));
+                }
+            }
+        });
+    }
+
+    // Новая плотная матрица со значением выражения
+    template <MatExpression E>
+    static MatrixDense<typename E::value_type> evaluate(const E& expr, unsigned numThreads = 0) {
+        MatrixDense<typename E::value_type> result(expr.rows(), expr.cols());
+        assign(result, expr, numThreads);
+        return result;
+    }
+};
+
+#endif
@@ -0,0 +1,242 @@
+#ifndef MATRIXFILE_H
+#define MATRIXFILE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Двоичный формат файла матрицы. Заголовок фиксированного размера, затем
+// разделы данных: первый с dataOffset, остальные с границы alignment от начала файла:
+//   MatrixDense    - m * n элементов построчно;
+//   MatrixDiagonal - m элементов диагонали;
+//   MatrixBlock    - битовая карта присутствия блоков (uint64), затем
+//                    присутствующие блоки в порядке номеров, каждый своим разделом;
+//   MatrixSparse   - rowPtr (uint64, m + 1), colIdx (uint32, nnz), values (nnz).
+// Элементы хранятся как в памяти, без преобразования, поэтому чтение - один
+// read на раздел, а плотную матрицу можно отобразить в память (MatrixDense::mapFile).
+struct MatrixFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;       // 0x01020304 в порядке байтов записавшей машины
+    uint32_t structure;       // Значение MatrixStructure
+    uint32_t elementType;     // Вид (1 - целый со знаком, 2 - без знака, 3 - плавающий) * 256 + размер
+    uint32_t alignment;
+    uint32_t reserved;
+    uint64_t rows, cols;
+    uint64_t params[4];       // Зависят от класса: размеры блоков, число ненулевых
+    uint64_t dataOffset;      // Начало первого раздела
+};
+
+struct MatrixFile {
+    static constexpr char magic[8] = {'M', 'A', 'T', 'R', 'I', 'X', 'B', '\0'};
+    static constexpr uint32_t version = 1;
+    static constexpr uint32_t byteOrder = 0x01020304;
+    static constexpr uint32_t alignment = 64;
+
+    template <typename T>
+    static uint32_t elementType() {
+        static_assert(std::is_arithmetic_v<T>, "Двоичный формат хранит только арифметические типы.");
+        uint32_t kind = std::is_floating_point_v<T> ? 3 : (std::is_signed_v<T> ? 1 : 2);
+        return kind * 256 + static_cast<uint32_t>(sizeof(T));
+    }
+
+    template <typename T>
+    static MatrixFileHeader header(uint32_t structure, uint64_t rows, uint64_t cols) {
+        MatrixFileHeader h{};
+        std::memcpy(h.magic, magic, sizeof(magic));
+        h.version = version;
+        h.byteOrder = byteOrder;
+        h.structure = structure;
+        h.elementType = elementType<T>();
+        h.alignment = alignment;
+        h.rows = rows;
+        h.cols = cols;
+        h.dataOffset = alignUp(sizeof(MatrixFileHeader));
+        return h;
+    }
+
+    // Заголовок того класса и типа элементов, которых ждет читающий
+    template <typename T>
+    static void check(const MatrixFileHeader& h, uint32_t structure) {
+        if (std::memcmp(h.magic, magic, sizeof(magic)) != 0 || h.version != version) {
+            throw std::runtime_error("Файл не содержит матрицу в двоичном формате.");
+        }
+        if (h.byteOrder != byteOrder) {
+            throw std::runtime_error("Файл записан на машине с другим порядком байтов.");
+        }
+        if (h.structure != structure) {
+            throw std::runtime_error("Файл содержит матрицу другого класса.");
+        }
+        if (h.elementType != elementType<T>()) {
+            throw std::runtime_error("Тип элементов в файле не совпадает с типом матрицы.");
+        }
+        if (h.alignment == 0 || h.alignment % alignof(T) != 0 || h.dataOffset % h.alignment != 0 ||
+            h.dataOffset < sizeof(MatrixFileHeader)) {
+            throw std::runtime_error("Некорректный заголовок двоичного файла матрицы.");
+        }
+    }
+
+    // Размер из заголовка для классов матриц с размерами unsigned
+    static unsigned dimension(uint64_t value) {
+        if (value > std::numeric_limits<unsigned>::max()) {
+            throw std::runtime_error("Размер матрицы в двоичном файле слишком велик.");
+        }
+        return static_cast<unsigned>(value);
+    }
+
+    // offset + count * elemSize с проверкой переполнения
+    static uint64_t sectionEnd(uint64_t offset, uint64_t count, uint64_t elemSize) {
+        const uint64_t limit = std::numeric_limits<uint64_t>::max();
+        if (elemSize != 0 && count > (limit - offset) / elemSize) {
+            throw std::runtime_error("Некорректный заголовок двоичного файла матрицы.");
+        }
+        return offset + count * elemSize;
+    }
+
+    static uint64_t alignUp(uint64_t offset, uint64_t align = alignment) {
+        return (offset + align - 1) / align * align;
+    }
+
+    // Последовательная запись разделов, каждый с границы выравнивания
+    class Writer {
+    public:
+        Writer(const std::string& filename, const MatrixFileHeader& h)
+            : out(filename, std::ios::binary), align(h.alignment) {
+            if (!out) {
+                throw std::runtime_error("Не удалось открыть файл для записи.");
+            }
+            write(&h, sizeof(h));
+        }
+
+        template <typename U>
+        void section(const U* data, size_t count) {
+            static const char zeros[alignment] = {};
+            uint64_t aligned = alignUp(position, align);
+            while (position < aligned) write(zeros, std::min<uint64_t>(aligned - position, sizeof(zeros)));
+            write(data, count * sizeof(U));
+        }
+
+        // Продолжение текущего раздела без выравнивания (раздел пишется частями)
+        template <typename U>
+        void append(const U* data, size_t count) {
+            write(data, count * sizeof(U));
+        }
+
+        void close() {
+            out.close();
+            if (!out) {
+                throw std::runtime_error("Ошибка записи двоичного файла матрицы.");
+            }
+        }
+
+    private:
+        std::ofstream out;
+        uint64_t align;
+        uint64_t position = 0;
+
+        void write(const void* data, uint64_t bytes) {
+            out.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+            position += bytes;
+        }
+    };
+
+    // Последовательное чтение разделов в порядке записи; первый раздел
+    // начинается с dataOffset, следующие - с границы alignment
+    class Reader {
+    public:
+        explicit Reader(const std::string& filename) : in(filename, std::ios::binary | std::ios::ate) {
+            if (!in) {
+                throw std::runtime_error("Не удалось открыть файл для чтения.");
+            }
+            fileSize = static_cast<uint64_t>(in.tellg());
+            in.seekg(0);
+            in.read(reinterpret_cast<char*>(&h), sizeof(h));
+            if (in.gcount() != static_cast<std::streamsize>(sizeof(h))) {
+                throw std::runtime_error("Файл не содержит матрицу в двоичном формате.");
+            }
+        }
+
+        const MatrixFileHeader& header() const { return h; }
+
+        // Число элементов следующего раздела, если раздел из count элементов U
+        // помещается в файл. Вызывается до выделения памяти под раздел, чтобы
+        // размер из испорченного заголовка не приводил к огромному выделению
+        template <typename U>
+        size_t expect(uint64_t count) const {
+            if (sectionEnd(next(), count, sizeof(U)) > fileSize) {
+                throw std::runtime_error("Двоичный файл матрицы обрезан.");
+            }
+            return static_cast<size_t>(count);
+        }
+
+        template <typename U>
+        void section(U* data, size_t count) {
+            expect<U>(count);
+            uint64_t start = next();
+            in.seekg(static_cast<std::streamoff>(start));
+            uint64_t bytes = count * sizeof(U);
+            in.read(reinterpret_cast<char*>(data), static_cast<std::streamsize>(bytes));
+            if (static_cast<uint64_t>(in.gcount()) != bytes) {
+                throw std::runtime_error("Двоичный файл матрицы обрезан.");
+            }
+            position = start + bytes;
+        }
+
+    private:
+        std::ifstream in;
+        MatrixFileHeader h;
+        uint64_t fileSize;
+        uint64_t position = 0;    // Конец прочитанного раздела; 0 - разделы еще не читались
+
+        uint64_t next() const { return position == 0 ? h.dataOffset : alignUp(position, h.alignment); }
+    };
+
+    // Отображение файла в память целиком, только для чтения
+    class Mapping {
+    public:
+        explicit Mapping(const std::string& filename) {
+            int fd = ::open(filename.c_str(), O_RDONLY);
+            if (fd < 0) {
+                throw std::runtime_error("Не удалось открыть файл для чтения.");
+            }
+            struct stat st;
+            if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(MatrixFileHeader)) {
+                ::close(fd);
+                throw std::runtime_error("Файл не содержит матрицу в двоичном формате.");
+            }
+            length = static_cast<size_t>(st.st_size);
+            base = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+            ::close(fd);
+            if (base == MAP_FAILED) {
+                throw std::runtime_error("Не удалось отобразить файл в память.");
+            }
+        }
+
+        ~Mapping() { ::munmap(base, length); }
+
+        Mapping(const Mapping&) = delete;
+        Mapping& operator=(const Mapping&) = delete;
+
+        const MatrixFileHeader& header() const { return *static_cast<const MatrixFileHeader*>(base); }
+        const char* data() const { return static_cast<const char*>(base); }
+        size_t size() const { return length; }
+
+    private:
+        void* base;
+        size_t length;
+    };
+};
+
+#endif
@@ -0,0 +1,317 @@
+#ifndef MATRIXKRONECKER_H
+#define MATRIXKRONECKER_H
+
+#include "Matrix.h"
+#include "MatrixDense.h"
+#include "MatrixFile.h"
+#include "TextCodec.h"
+#include "Gemm.h"
+#include "ThreadPool.h"
+#include "Transpose.h"
+#include <algorithm>
+#include <climits>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+// Ленивое произведение Кронекера A ⊗ B: хранятся только множители, элемент
+// ((i, k), (j, l)) = A(i, j) * B(k, l) вычисляется при обращении. Множителем может
+// быть любая матрица, в том числе другое MatrixKronecker, что дает цепочки
+// A ⊗ B ⊗ C ... без материализации.
+//
+// Умножение на вектор - "vec-трюк": при A m x n, B p x q вектор x длины nq
+// укладывается по строкам в X (n x q), и (A ⊗ B) x = vec(A X B^T). Это
+// O(npq + mnp) операций вместо O(mnpq) и O(np) памяти вместо O(mnpq).
+// Для вложенных множителей тот же прием применяется рекурсивно.
+template <typename T = double>
+class MatrixKronecker : public Matrix<T> {
+private:
+    std::shared_ptr<const Matrix<T>> A, B;
+
+    // Y = X * M^T для count строк: строка r результата - M, умноженная на строку r X.
+    // X - count x M.cols(), Y - count x M.rows(), обе подряд по строкам
+    static void apply(const Matrix<T>& M, unsigned count, const T* X, T* Y, unsigned numThreads) {
+        unsigned m = M.rows();
+        unsigned n = M.cols();
+        if (count == 0 || m == 0) return;
+        if (n == 0) {
+            std::fill(Y, Y + static_cast<size_t>(count) * m, T());
+            return;
+        }
+        if (M.structure() == MatrixStructure::Kronecker) {
+            static_cast<const MatrixKronecker<T>&>(M).applyKronecker(count, X, Y, numThreads);
+            return;
+        }
+
+        // Лист: M^T в построчном хранении, затем один Gemm на все строки
+        std::vector<T> copy;
+        const T* rows = M.rowData(0);
+        if (M.structure() != MatrixStructure::Dense) {
+            copy.resize(static_cast<size_t>(m) * n);
+            M.copyTile(0, 0, m, n, copy.data(), n);
+            rows = copy.data();
+        }
+        std::vector<T> transposed(static_cast<size_t>(n) * m);
+        Transpose<T>::outOfPlace(m, n, rows, n, transposed.data(), m, numThreads);
+        Gemm<T>::multiply(count, m, n, T(1), X, n, transposed.data(), m, T(), Y, m, numThreads);
+    }
+
+    // Для каждой строки x: X (n x q), Z = X B^T (n x p), Y = A Z (m x p).
+    // A Z считается как (Z^T A^T)^T, чтобы оба шага были вида "строки на M^T"
+    void applyKronecker(unsigned count, const T* X, T* Y, unsigned numThreads) const {
+        unsigned m = A->rows(), n = A->cols();
+        unsigned p = B->rows();
+        size_t np = static_cast<size_t>(n) * p;
+        size_t mp = static_cast<size_t>(m) * p;
+
+        std::vector<T> Z(count * np);
+        apply(*B, count * n, X, Z.data(), numThreads);
+        std::vector<T> Zt(count * np);
+        for (unsigned r = 0; r < count; ++r) {
+            Transpose<T>::outOfPlace(n, p, Z.data() + r * np, p, Zt.data() + r * np, n, numThreads);
+        }
+        std::vector<T> W(count * mp);
+        apply(*A, count * p, Zt.data(), W.data(), numThreads);
+        for (unsigned r = 0; r < count; ++r) {
+            Transpose<T>::outOfPlace(p, m, W.data() + r * mp, m, Y + r * mp, p, numThreads);
+        }
+    }
+
+    // Согласованы ли размеры множителей для почленных операций по множителям
+    bool sameFactorShapes(const Matrix<T>& other) const {
+        if (other.structure() != MatrixStructure::Kronecker) return false;
+        const MatrixKronecker<T>& right = static_cast<const MatrixKronecker<T>&>(other);
+        return A->rows() == right.A->rows() && A->cols() == right.A->cols() &&
+               B->rows() == right.B->rows() && B->cols() == right.B->cols() &&
+               rows() > 0 && cols() > 0;
+    }
+
+    // Печать всех строк (copyRow) через TextCodec с разделителем separator после каждого числа
+    void writeRows(std::ostream& os, TextCodec::Format format, char separator) const {
+        TextCodec::writeRows(os, rows(), cols(), format, [&](size_t i, TextCodec::Text& text) {
+            thread_local std::vector<T> row;
+            row.resize(cols());
+            copyRow(static_cast<unsigned>(i), 0, cols(), row.data());
+            for (const T& x : row) {
+                text.value(x);
+                text.put(separator);
+            }
+            text.put('\n');
+        });
+    }
+
+    static std::shared_ptr<const Matrix<T>> own(Matrix<T>* matrix) {
+        return std::shared_ptr<const Matrix<T>>(matrix);
+    }
+
+public:
+    // Конструктор: множители разделяются, а не копируются
+    MatrixKronecker(std::shared_ptr<const Matrix<T>> left, std::shared_ptr<const Matrix<T>> right)
+        : A(std::move(left)), B(std::move(right)) {
+        if (!A || !B) {
+            throw std::invalid_argument("Множители произведения Кронекера не заданы.");
+        }
+        if (static_cast<unsigned long long>(A->rows()) * B->rows() > UINT_MAX ||
+            static_cast<unsigned long long>(A->cols()) * B->cols() > UINT_MAX) {
+            throw std::invalid_argument("Размер произведения Кронекера слишком велик.");
+        }
+    }
+
+    const Matrix<T>& left() const { return *A; }
+    const Matrix<T>& right() const { return *B; }
+
+    unsigned rows() const override { return A->rows() * B->rows(); }
+    unsigned cols() const override { return A->cols() * B->cols(); }
+
+    MatrixStructure structure() const override { return MatrixStructure::Kronecker; }
+
+    // Доступ к элементам
+    T operator()(unsigned i, unsigned j) const override {
+        unsigned p = B->rows(), q = B->cols();
+        return (*A)(i / p, j / q) * (*B)(i % p, j % q);
+    }
+
+    // Отрезок строки (a, b): нужная часть строки a множителя A, умноженная на строку b B.
+    // Строки множителей читаются в буферы потока; множитель сам может быть кронекеровым
+    // произведением и вызвать copyRow изнутри, поэтому у каждого уровня вложенности
+    // своя пара буферов (deque при росте не перемещает уже выданные)
+    void copyRow(unsigned i, unsigned j, unsigned count, T* out) const override {
+        if (count == 0) return;
+        unsigned p = B->rows(), q = B->cols();
+        unsigned first = j / q;
+        unsigned last = (j + count - 1) / q;
+
+        thread_local std::deque<std::vector<T>> buffers;
+        thread_local size_t depth = 0;
+        if (buffers.size() < 2 * depth + 2) buffers.resize(2 * depth + 2);
+        std::vector<T>& rowA = buffers[2 * depth];
+        std::vector<T>& rowB = buffers[2 * depth + 1];
+        rowA.resize(last - first + 1);
+        rowB.resize(q);
+        const T* b;
+        {
+            struct Level {
+                size_t& depth;
+                ~Level() { --depth; }
+            } level{++depth};
+            A->copyRow(i / p, first, last - first + 1, rowA.data());
+            b = B->readRow(i % p, rowB.data());
+        }
+        unsigned k = 0;
+        while (k < count) {
+            unsigned c = j + k;
+            unsigned l = c % q;
+            unsigned len = std::min(q - l, count - k);
+            T a = rowA[c / q - first];
+            for (unsigned t = 0; t < len; ++t) out[k + t] = a * b[l + t];
+            k += len;
+        }
+    }
+
+    // y = (A ⊗ B) x без построения матрицы; numThreads = 0 - все потоки общего пула
+    void multiplyVector(const T* x, T* y, unsigned numThreads = 0) const {
+        apply(*this, 1, x, y, numThreads);
+    }
+
+    // То же для count векторов сразу: строка r Y - произведение на строку r X
+    void multiplyVectors(unsigned count, const T* X, T* Y, unsigned numThreads = 0) const {
+        apply(*this, count, X, Y, numThreads);
+    }
+
+    // Плотная копия всей матрицы, строки заполняются параллельно
+    MatrixDense<T> toDense() const {
+        MatrixDense<T> result(rows(), cols());
+        if (rows() == 0 || cols() == 0) return result;
+        const unsigned rowsPerTask = 64;
+        unsigned tasks = (rows() + rowsPerTask - 1) / rowsPerTask;
+        ThreadPool::shared().parallelFor(tasks, 0, [&](unsigned t) {
+            unsigned end = std::min(rows(), (t + 1) * rowsPerTask);
+            for (unsigned i = t * rowsPerTask; i < end; ++i) copyRow(i, 0, cols(), &result(i, 0));
+        });
+        return result;
+    }
+
+    // Операции с матрицами
+
+    // Произведение Кронекера только вычисляется, изменять его на месте нельзя
+    Matrix<T>& operator+=(const Matrix<T>&) override {
+        throw std::logic_error("Ленивое произведение Кронекера нельзя изменять на месте.");
+    }
+
+    Matrix<T>& operator-=(const Matrix<T>&) override {
+        throw std::logic_error("Ленивое произведение Кронекера нельзя изменять на месте.");
+    }
+
+    // Сумма и разность в общем случае не раскладываются на множители: результат плотный
+    Matrix<T>* operator+(const Matrix<T>& other) const override {
+        return toDense() + other;
+    }
+
+    Matrix<T>* operator-(const Matrix<T>& other) const override {
+        return toDense() - other;
+    }
+
+    // (A ⊗ B)(C ⊗ D) = AC ⊗ BD при согласованных множителях; иначе каждый
+    // столбец other умножается vec-трюком, результат плотный
+    Matrix<T>* operator*(const Matrix<T>& other) const override {
+        if (cols() != other.rows()) {
+            throw std::invalid_argument("Внутренние размеры матриц должны совпадать для умножения.");
+        }
+        if (other.structure() == MatrixStructure::Kronecker) {
+            const MatrixKronecker<T>& right = static_cast<const MatrixKronecker<T>&>(other);
+            if (A->cols() == right.A->rows() && B->cols() == right.B->rows()) {
+                return new MatrixKronecker<T>(own(*A * *right.A), own(*B * *right.B));
+            }
+        }
+
+        unsigned k = other.rows(), n = other.cols();
+        MatrixDense<T>* result = new MatrixDense<T>(rows(), n);
+        if (rows() == 0 || n == 0) return result;
+        // Столбцы other - строки other^T; (this * other)^T = other^T * this^T
+        std::vector<T> copy(static_cast<size_t>(k) * n), columns(static_cast<size_t>(n) * k);
+        other.copyTile(0, 0, k, n, copy.data(), n);
+        Transpose<T>::outOfPlace(k, n, copy.data(), n, columns.data(), k);
+        std::vector<T> product(static_cast<size_t>(n) * rows());
+        apply(*this, n, columns.data(), product.data(), 0);
+        Transpose<T>::outOfPlace(n, rows(), product.data(), rows(), &(*result)(0, 0), n);
+        return result;
+    }
+
+    // (A ⊗ B) ∘ (C ⊗ D) = (A ∘ C) ⊗ (B ∘ D) при одинаковых размерах множителей
+    Matrix<T>* elemMult(const Matrix<T>& other) const override {
+        if (rows() != other.rows() || cols() != other.cols()) {
+            throw std::invalid_argument("Размеры матриц должны совпадать для почленного умножения.");
+        }
+        if (sameFactorShapes(other)) {
+            const MatrixKronecker<T>& right = static_cast<const MatrixKronecker<T>&>(other);
+            return new MatrixKronecker<T>(own(A->elemMult(*right.A)), own(B->elemMult(*right.B)));
+        }
+        return toDense().elemMult(other);
+    }
+
+    // Делитель C ⊗ D имеет нуль тогда и только тогда, когда нуль есть в C или D,
+    // поэтому деление по множителям бросает исключение в тех же случаях
+    Matrix<T>* elemDiv(const Matrix<T>& other) const override {
+        if (rows() != other.rows() || cols() != other.cols()) {
+            throw std::invalid_argument("Размеры матриц должны совпадать для почленного деления.");
+        }
+        if (sameFactorShapes(other)) {
+            const MatrixKronecker<T>& right = static_cast<const MatrixKronecker<T>&>(other);
+            return new MatrixKronecker<T>(own(A->elemDiv(*right.A)), own(B->elemDiv(*right.B)));
+        }
+        return toDense().elemDiv(other);
+    }
+
+    // (A ⊗ B)^T = A^T ⊗ B^T
+    MatrixKronecker<T>* transpose() const override {
+        return new MatrixKronecker<T>(own(A->transpose()), own(B->transpose()));
+    }
+
+    // Ленивое произведение строится из множителей, а не читается из файла
+    void importFromFile(const std::string&) override {
+        throw std::runtime_error("Произведение Кронекера не импортируется из файла: постройте его из множителей.");
+    }
+
+    // Экспорт в формате MatrixDense: файл читается MatrixDense::importFromFile
+    void exportToFile(const std::string& filename) const override {
+        std::ofstream outfile(filename);
+        if (!outfile) {
+            throw std::runtime_error("Не удалось открыть файл для записи.");
+        }
+
+        outfile << "MatrixDense\n";
+        outfile << rows() << " " << cols() << "\n";
+
+        writeRows(outfile, TextCodec::Format(), ' ');
+
+        outfile.close();
+    }
+
+    // Ленивое произведение строится из множителей, а не читается из файла
+    void importFromBinary(const std::string&) override {
+        throw std::runtime_error("Произведение Кронекера не импортируется из файла: постройте его из множителей.");
+    }
+
+    // Двоичный экспорт в формате MatrixDense, строки пишутся по одной без
+    // построения плотной матрицы
+    void exportToBinary(const std::string& filename) const override {
+        MatrixFile::Writer writer(filename, MatrixFile::header<T>(static_cast<uint32_t>(MatrixStructure::Dense), rows(), cols()));
+        std::vector<T> row(cols());
+        for (unsigned i = 0; i < rows(); ++i) {
+            copyRow(i, 0, cols(), row.data());
+            if (i == 0) writer.section(row.data(), row.size());
+            else writer.append(row.data(), row.size());
+        }
+        writer.close();
+    }
+
+    // Метод для печати матрицы
+    void print(std::ostream& os = std::cout) const override {
+        writeRows(os, TextCodec::Format::of(os), '\t');
+    }
+};
+
+#endif
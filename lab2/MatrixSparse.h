@@ -0,0 +1,584 @@
+#ifndef MATRIXSPARSE_H
+#define MATRIXSPARSE_H
+
+#include "Matrix.h"
+#include "MatrixDense.h"
+#include "MatrixFile.h"
+#include "TextCodec.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+// Разреженная матрица в формате CSR: для строки i ненулевые элементы лежат
+// в colIdx/values на отрезке [rowPtr[i], rowPtr[i + 1]) по возрастанию столбца.
+// Формат CSC (по столбцам) - это CSR транспонированной матрицы, toCSC/fromCSC
+// переводят между ними. Память и время операций пропорциональны числу
+// ненулевых элементов, а не m * n. Результаты строятся в два параллельных
+// прохода по полосам строк: подсчет ненулевых, префиксные суммы, заполнение.
+template <typename T = double>
+class MatrixSparse : public Matrix<T> {
+public:
+    // Хранение по столбцам: для столбца j - отрезок [colPtr[j], colPtr[j + 1])
+    struct CSC {
+        std::vector<size_t> colPtr;
+        std::vector<unsigned> rowIdx;
+        std::vector<T> values;
+    };
+
+private:
+    unsigned _m, _n;
+    std::vector<size_t> rowPtr;
+    std::vector<unsigned> colIdx;
+    std::vector<T> values;
+
+    static constexpr unsigned rowsPerTask = 256;
+
+    // func(begin, end) для полос строк в общем пуле потоков
+    template <typename Func>
+    static void forRowStrips(unsigned m, unsigned numThreads, Func func) {
+        unsigned tasks = (m + rowsPerTask - 1) / rowsPerTask;
+        ThreadPool::shared().parallelFor(tasks, numThreads, [&](unsigned t) {
+            func(t * rowsPerTask, std::min(m, (t + 1) * rowsPerTask));
+        });
+    }
+
+    // Сборка CSR: count(i) - число элементов строки i, fill(i, cols, vals) записывает их
+    template <typename Count, typename Fill>
+    void build(unsigned numThreads, Count count, Fill fill) {
+        rowPtr.assign(static_cast<size_t>(_m) + 1, 0);
+        forRowStrips(_m, numThreads, [&](unsigned begin, unsigned end) {
+            for (unsigned i = begin; i < end; ++i) rowPtr[i + 1] = count(i);
+        });
+        for (unsigned i = 0; i < _m; ++i) rowPtr[i + 1] += rowPtr[i];
+        colIdx.resize(rowPtr[_m]);
+        values.resize(rowPtr[_m]);
+        forRowStrips(_m, numThreads, [&](unsigned begin, unsigned end) {
+            for (unsigned i = begin; i < end; ++i) {
+                fill(i, colIdx.data() + rowPtr[i], values.data() + rowPtr[i]);
+            }
+        });
+    }
+
+    // Слияние строк двух разреженных матриц одного размера.
+    // keepLeft/keepRight - брать ли элементы, присутствующие только в одной из матриц.
+    // Нулевые результаты (например, в A - A) не хранятся ни при подсчете, ни при заполнении
+    template <typename Op>
+    MatrixSparse<T>* merge(const MatrixSparse<T>& other, Op op, bool keepLeft, bool keepRight) const {
+        MatrixSparse<T>* result = new MatrixSparse<T>(_m, _n);
+        auto walk = [&](unsigned i, unsigned* cols, T* vals) {
+            size_t a = rowPtr[i], aEnd = rowPtr[i + 1];
+            size_t b = other.rowPtr[i], bEnd = other.rowPtr[i + 1];
+            size_t k = 0;
+            auto put = [&](unsigned j, T value) {
+                if (value == T()) return;
+                if (cols) { cols[k] = j; vals[k] = value; }
+                ++k;
+            };
+            while (a < aEnd || b < bEnd) {
+                unsigned ca = a < aEnd ? colIdx[a] : _n;
+                unsigned cb = b < bEnd ? other.colIdx[b] : _n;
+                if (ca == cb) {
+                    put(ca, op(values[a], other.values[b]));
+                    ++a; ++b;
+                } else if (ca < cb) {
+                    if (keepLeft) put(ca, op(values[a], T()));
+                    ++a;
+                } else {
+                    if (keepRight) put(cb, op(T(), other.values[b]));
+                    ++b;
+                }
+            }
+            return k;
+        };
+        result->build(0, [&](unsigned i) { return walk(i, nullptr, nullptr); },
+                      [&](unsigned i, unsigned* cols, T* vals) { walk(i, cols, vals); });
+        return result;
+    }
+
+    // *this = merge(other) для += и -=; разреженная other не копируется
+    template <typename Op>
+    void mergeAssign(const Matrix<T>& other, Op op) {
+        std::unique_ptr<MatrixSparse<T>> merged(other.structure() == MatrixStructure::Sparse
+            ? merge(static_cast<const MatrixSparse<T>&>(other), op, true, true)
+            : merge(fromMatrix(other), op, true, true));
+        *this = std::move(*merged);
+    }
+
+    // Та же структура, значения - func(i, j, value); func может бросить исключение
+    template <typename Func>
+    MatrixSparse<T>* mapValues(Func func) const {
+        std::unique_ptr<MatrixSparse<T>> result(new MatrixSparse<T>(*this));
+        forRowStrips(_m, 0, [&](unsigned begin, unsigned end) {
+            for (unsigned i = begin; i < end; ++i) {
+                for (size_t k = rowPtr[i]; k < rowPtr[i + 1]; ++k) {
+                    result->values[k] = func(i, colIdx[k], values[k]);
+                }
+            }
+        });
+        return result.release();
+    }
+
+    void checkSameSize(const Matrix<T>& other, const char* message) const {
+        if (_m != other.rows() || _n != other.cols()) {
+            throw std::invalid_argument(message);
+        }
+    }
+
+public:
+    // Конструктор: пустая матрица m x n
+    MatrixSparse(unsigned m, unsigned n) : _m(m), _n(n), rowPtr(static_cast<size_t>(m) + 1, 0) {}
+
+    // Конструктор из готовых массивов CSR
+    MatrixSparse(unsigned m, unsigned n, std::vector<size_t> rowPtr,
+                 std::vector<unsigned> colIdx, std::vector<T> values)
+        : _m(m), _n(n), rowPtr(std::move(rowPtr)), colIdx(std::move(colIdx)), values(std::move(values)) {
+        if (this->rowPtr.size() != static_cast<size_t>(_m) + 1 || this->rowPtr[0] != 0 ||
+            this->rowPtr[_m] != this->colIdx.size() || this->colIdx.size() != this->values.size()) {
+            throw std::invalid_argument("Некорректные массивы CSR.");
+        }
+        for (unsigned i = 0; i < _m; ++i) {
+            if (this->rowPtr[i] > this->rowPtr[i + 1]) {
+                throw std::invalid_argument("Некорректные массивы CSR.");
+            }
+            for (size_t k = this->rowPtr[i]; k < this->rowPtr[i + 1]; ++k) {
+                if (this->colIdx[k] >= _n || (k > this->rowPtr[i] && this->colIdx[k] <= this->colIdx[k - 1])) {
+                    throw std::invalid_argument("Некорректные массивы CSR.");
+                }
+            }
+        }
+    }
+
+    // Копирование и перемещение - по умолчанию, хранение в std::vector
+
+    // Из троек (строка, столбец, значение); повторяющиеся позиции суммируются
+    static MatrixSparse<T> fromTriplets(unsigned m, unsigned n,
+                                        std::vector<std::tuple<unsigned, unsigned, T>> triplets) {
+        for (const auto& t : triplets) {
+            if (std::get<0>(t) >= m || std::get<1>(t) >= n) {
+                throw std::out_of_range("Индекс за пределами матрицы.");
+            }
+        }
+        std::sort(triplets.begin(), triplets.end(), [](const auto& a, const auto& b) {
+            return std::get<0>(a) != std::get<0>(b) ? std::get<0>(a) < std::get<0>(b) : std::get<1>(a) < std::get<1>(b);
+        });
+        MatrixSparse<T> result(m, n);
+        for (size_t k = 0; k < triplets.size(); ++k) {
+            const auto& [i, j, v] = triplets[k];
+            if (k > 0 && std::get<0>(triplets[k - 1]) == i && std::get<1>(triplets[k - 1]) == j) {
+                result.values.back() += v;
+                continue;
+            }
+            result.colIdx.push_back(j);
+            result.values.push_back(v);
+            ++result.rowPtr[i + 1];
+        }
+        for (unsigned i = 0; i < m; ++i) result.rowPtr[i + 1] += result.rowPtr[i];
+        return result;
+    }
+
+    // Параллельное преобразование из матрицы любого типа: строки читаются пакетно,
+    // в CSR попадают только ненулевые элементы
+    static MatrixSparse<T> fromMatrix(const Matrix<T>& other, unsigned numThreads = 0) {
+        if (other.structure() == MatrixStructure::Sparse) {
+            return static_cast<const MatrixSparse<T>&>(other);
+        }
+        MatrixSparse<T> result(other.rows(), other.cols());
+        if (other.structure() == MatrixStructure::Diagonal) {
+            result.build(numThreads, [&](unsigned i) { return other(i, i) != T() ? 1 : 0; },
+                         [&](unsigned i, unsigned* cols, T* vals) {
+                             if (other(i, i) != T()) { cols[0] = i; vals[0] = other(i, i); }
+                         });
+            return result;
+        }
+        unsigned n = other.cols();
+        auto readRow = [&](unsigned i) {
+            thread_local std::vector<T> buffer;
+            buffer.resize(n);
+            return other.readRow(i, buffer.data());
+        };
+        result.build(numThreads, [&](unsigned i) {
+            const T* row = readRow(i);
+            return static_cast<size_t>(std::count_if(row, row + n, [](T v) { return v != T(); }));
+        }, [&](unsigned i, unsigned* cols, T* vals) {
+            const T* row = readRow(i);
+            for (unsigned j = 0; j < n; ++j) {
+                if (row[j] != T()) { *cols++ = j; *vals++ = row[j]; }
+            }
+        });
+        return result;
+    }
+
+    static MatrixSparse<T> fromCSC(unsigned m, unsigned n, const CSC& csc, unsigned numThreads = 0) {
+        MatrixSparse<T> transposed(n, m, csc.colPtr, csc.rowIdx, csc.values);
+        return transposed.transposed(numThreads);
+    }
+
+    CSC toCSC(unsigned numThreads = 0) const {
+        MatrixSparse<T> transposed = this->transposed(numThreads);
+        return CSC{std::move(transposed.rowPtr), std::move(transposed.colIdx), std::move(transposed.values)};
+    }
+
+    unsigned rows() const override { return _m; }
+    unsigned cols() const override { return _n; }
+
+    size_t nonZeros() const { return values.size(); }
+    const std::vector<size_t>& rowPointers() const { return rowPtr; }
+    const std::vector<unsigned>& columnIndices() const { return colIdx; }
+    const std::vector<T>& nonZeroValues() const { return values; }
+
+    MatrixStructure structure() const override { return MatrixStructure::Sparse; }
+
+    // Доступ к элементам: двоичный поиск в строке
+    T operator()(unsigned i, unsigned j) const override {
+        auto begin = colIdx.begin() + rowPtr[i];
+        auto end = colIdx.begin() + rowPtr[i + 1];
+        auto it = std::lower_bound(begin, end, j);
+        return (it != end && *it == j) ? values[it - colIdx.begin()] : T();
+    }
+
+    void copyRow(unsigned i, unsigned j, unsigned count, T* out) const override {
+        std::fill(out, out + count, T());
+        auto begin = colIdx.begin() + rowPtr[i];
+        auto end = colIdx.begin() + rowPtr[i + 1];
+        for (auto it = std::lower_bound(begin, end, j); it != end && *it < j + count; ++it) {
+            out[*it - j] = values[it - colIdx.begin()];
+        }
+    }
+
+    // y = A * x (SpMV), строки параллельно
+    void multiplyVector(const T* x, T* y, unsigned numThreads = 0) const {
+        forRowStrips(_m, numThreads, [&](unsigned begin, unsigned end) {
+            for (unsigned i = begin; i < end; ++i) {
+                T sum = T();
+                for (size_t k = rowPtr[i]; k < rowPtr[i + 1]; ++k) {
+                    sum += values[k] * x[colIdx[k]];
+                }
+                y[i] = sum;
+            }
+        });
+    }
+
+    // Транспонирование, оно же перевод CSR в CSC: каждая полоса строк считает
+    // свою гистограмму столбцов, по ним каждая полоса знает, куда писать
+    MatrixSparse<T> transposed(unsigned numThreads = 0) const {
+        MatrixSparse<T> result(_n, _m);
+        unsigned parts = numThreads == 0 ? ThreadPool::shared().size() : numThreads;
+        // Гистограммы всех полос вместе не больше самой матрицы
+        size_t byMemory = (values.size() + _m) / (static_cast<size_t>(_n) + 1);
+        parts = static_cast<unsigned>(std::clamp<size_t>(byMemory, 1, std::max(1u, std::min(parts, _m))));
+        unsigned stripRows = std::max(1u, (_m + parts - 1) / parts);
+        std::vector<size_t> offsets(static_cast<size_t>(parts) * _n, 0);
+
+        ThreadPool::shared().parallelFor(parts, numThreads, [&](unsigned p) {
+            size_t* hist = offsets.data() + static_cast<size_t>(p) * _n;
+            unsigned end = std::min(_m, (p + 1) * stripRows);
+            for (size_t k = rowPtr[std::min(_m, p * stripRows)]; k < rowPtr[end]; ++k) ++hist[colIdx[k]];
+        });
+        size_t position = 0;
+        for (unsigned j = 0; j < _n; ++j) {
+            result.rowPtr[j] = position;
+            for (unsigned p = 0; p < parts; ++p) {
+                size_t count = offsets[static_cast<size_t>(p) * _n + j];
+                offsets[static_cast<size_t>(p) * _n + j] = position;
+                position += count;
+            }
+        }
+        result.rowPtr[_n] = position;
+        result.colIdx.resize(position);
+        result.values.resize(position);
+        ThreadPool::shared().parallelFor(parts, numThreads, [&](unsigned p) {
+            size_t* next = offsets.data() + static_cast<size_t>(p) * _n;
+            unsigned end = std::min(_m, (p + 1) * stripRows);
+            for (unsigned i = std::min(_m, p * stripRows); i < end; ++i) {
+                for (size_t k = rowPtr[i]; k < rowPtr[i + 1]; ++k) {
+                    size_t dst = next[colIdx[k]]++;
+                    result.colIdx[dst] = i;
+                    result.values[dst] = values[k];
+                }
+            }
+        });
+        return result;
+    }
+
+    // Операции с матрицами
+
+    Matrix<T>& operator+=(const Matrix<T>& other) override {
+        checkSameSize(other, "Размеры матриц должны совпадать для сложения.");
+        mergeAssign(other, [](T a, T b) { return a + b; });
+        return *this;
+    }
+
+    Matrix<T>& operator-=(const Matrix<T>& other) override {
+        checkSameSize(other, "Размеры матриц должны совпадать для вычитания.");
+        mergeAssign(other, [](T a, T b) { return a - b; });
+        return *this;
+    }
+
+    // Сумма с разреженной - разреженная (объединение структур), с остальными - плотная
+    Matrix<T>* operator+(const Matrix<T>& other) const override {
+        checkSameSize(other, "Размеры матриц должны совпадать для сложения.");
+        if (other.structure() == MatrixStructure::Sparse) {
+            return merge(static_cast<const MatrixSparse<T>&>(other), [](T a, T b) { return a + b; }, true, true);
+        }
+        return addToDense(other, T(1));
+    }
+
+    Matrix<T>* operator-(const Matrix<T>& other) const override {
+        checkSameSize(other, "Размеры матриц должны совпадать для вычитания.");
+        if (other.structure() == MatrixStructure::Sparse) {
+            return merge(static_cast<const MatrixSparse<T>&>(other), [](T a, T b) { return a - b; }, true, true);
+        }
+        return addToDense(other, T(-1));
+    }
+
+    // Матричное умножение: на разреженную - SpGEMM, на диагональную - масштабирование
+    // столбцов, иначе строки результата накапливаются из строк плотного множителя
+    Matrix<T>* operator*(const Matrix<T>& other) const override {
+        if (_n != other.rows()) {
+            throw std::invalid_argument("Внутренние размеры матриц должны совпадать для умножения.");
+        }
+        if (other.structure() == MatrixStructure::Sparse) {
+            return multiplySparse(static_cast<const MatrixSparse<T>&>(other));
+        }
+        if (other.structure() == MatrixStructure::Diagonal) {
+            std::vector<T> d(_n);
+            for (unsigned j = 0; j < _n; ++j) d[j] = other(j, j);
+            return scaleCols(d.data());
+        }
+
+        unsigned n = other.cols();
+        MatrixDense<T> copy(0, 0);
+        const T* b = other.rowData(0);
+        if (other.structure() != MatrixStructure::Dense) {
+            copy = MatrixDense<T>(_n, n);
+            if (_n > 0 && n > 0) other.copyTile(0, 0, _n, n, &copy(0, 0), n);
+            b = copy.rowData(0);
+        }
+        MatrixDense<T>* result = new MatrixDense<T>(_m, n);
+        forRowStrips(_m, 0, [&](unsigned begin, unsigned end) {
+            for (unsigned i = begin; i < end; ++i) {
+                T* c = &(*result)(i, 0);
+                for (size_t k = rowPtr[i]; k < rowPtr[i + 1]; ++k) {
+                    const T* row = b + static_cast<size_t>(colIdx[k]) * n;
+                    T a = values[k];
+                    for (unsigned j = 0; j < n; ++j) c[j] += a * row[j];
+                }
+            }
+        });
+        return result;
+    }
+
+    // SpGEMM по Густавсону: строка i результата - сумма строк B, взятых с весами
+    // из строки i матрицы A. Каждый поток держит свой плотный аккумулятор длины n
+    // и метки занятых столбцов; метка - номер строки, поэтому аккумулятор
+    // не очищается между строками.
+    MatrixSparse<T>* multiplySparse(const MatrixSparse<T>& other, unsigned numThreads = 0) const {
+        if (_n != other._m) {
+            throw std::invalid_argument("Внутренние размеры матриц должны совпадать для умножения.");
+        }
+        unsigned n = other._n;
+        struct Accumulator {
+            std::vector<uint64_t> mark;
+            std::vector<T> sum;
+            std::vector<unsigned> touched;
+            uint64_t stamp = 0;
+        };
+        auto accumulator = [n]() -> Accumulator& {
+            thread_local Accumulator acc;
+            if (acc.mark.size() < n) {
+                acc.mark.resize(n, 0);
+                acc.sum.resize(n);
+            }
+            return acc;
+        };
+        // Проход по строке i: столбцы результата попадают в acc.touched
+        auto gather = [&](unsigned i, Accumulator& acc, bool numeric) {
+            uint64_t stamp = ++acc.stamp;
+            acc.touched.clear();
+            for (size_t ka = rowPtr[i]; ka < rowPtr[i + 1]; ++ka) {
+                unsigned k = colIdx[ka];
+                T a = values[ka];
+                for (size_t kb = other.rowPtr[k]; kb < other.rowPtr[k + 1]; ++kb) {
+                    unsigned j = other.colIdx[kb];
+                    if (acc.mark[j] != stamp) {
+                        acc.mark[j] = stamp;
+                        acc.touched.push_back(j);
+                        if (numeric) acc.sum[j] = a * other.values[kb];
+                    } else if (numeric) {
+                        acc.sum[j] += a * other.values[kb];
+                    }
+                }
+            }
+        };
+
+        MatrixSparse<T>* result = new MatrixSparse<T>(_m, n);
+        result->build(numThreads, [&](unsigned i) {
+            Accumulator& acc = accumulator();
+            gather(i, acc, false);
+            return acc.touched.size();
+        }, [&](unsigned i, unsigned* cols, T* vals) {
+            Accumulator& acc = accumulator();
+            gather(i, acc, true);
+            std::sort(acc.touched.begin(), acc.touched.end());
+            for (unsigned j : acc.touched) {
+                *cols++ = j;
+                *vals++ = acc.sum[j];
+            }
+        });
+        return result;
+    }
+
+    MatrixSparse<T>* scaleRows(const T* d) const override {
+        return mapValues([d](unsigned i, unsigned, T v) { return d[i] * v; });
+    }
+
+    MatrixSparse<T>* scaleCols(const T* d) const override {
+        return mapValues([d](unsigned, unsigned j, T v) { return v * d[j]; });
+    }
+
+    // Почленное умножение: результат не шире структуры this
+    Matrix<T>* elemMult(const Matrix<T>& other) const override {
+        checkSameSize(other, "Размеры матриц должны совпадать для почленного умножения.");
+        if (other.structure() == MatrixStructure::Diagonal) {
+            return other.elemMult(*this);
+        }
+        if (other.structure() == MatrixStructure::Sparse) {
+            return merge(static_cast<const MatrixSparse<T>&>(other), [](T a, T b) { return a * b; }, false, false);
+        }
+        return mapValues([&other](unsigned i, unsigned j, T v) { return v * other(i, j); });
+    }
+
+    // Почленное деление. На ноль проверяются только делители ненулевых
+    // элементов this: 0 / 0 вне структуры считается нулем, иначе пришлось бы
+    // обходить все m * n элементов
+    Matrix<T>* elemDiv(const Matrix<T>& other) const override {
+        checkSameSize(other, "Размеры матриц должны совпадать для почленного деления.");
+        return mapValues([&other](unsigned i, unsigned j, T v) {
+            T denom = other(i, j);
+            if (denom == T()) {
+                throw std::runtime_error("Деление на ноль при почленном делении матриц.");
+            }
+            return v / denom;
+        });
+    }
+
+    MatrixSparse<T>* transpose() const override {
+        return new MatrixSparse<T>(transposed());
+    }
+
+    // Импорт из файла: размеры, число ненулевых, затем тройки "строка столбец значение"
+    void importFromFile(const std::string& filename) override {
+        TextCodec::Reader reader(filename);
+        if (reader.line() != "MatrixSparse") {
+            throw std::runtime_error("Файл не содержит данные MatrixSparse.");
+        }
+
+        unsigned m = reader.value<unsigned>();
+        unsigned n = reader.value<unsigned>();
+        size_t count = reader.value<size_t>();
+        std::vector<std::tuple<unsigned, unsigned, T>> triplets(count);
+        for (auto& [i, j, v] : triplets) {
+            i = reader.value<unsigned>();
+            j = reader.value<unsigned>();
+            v = reader.value<T>();
+        }
+        *this = fromTriplets(m, n, std::move(triplets));
+    }
+
+    // Экспорт в файл
+    void exportToFile(const std::string& filename) const override {
+        std::ofstream outfile(filename);
+        if (!outfile) {
+            throw std::runtime_error("Не удалось открыть файл для записи.");
+        }
+
+        outfile << "MatrixSparse\n";
+        outfile << _m << " " << _n << " " << values.size() << "\n";
+
+        TextCodec::writeRows(outfile, _m, 3 * values.size() / std::max(1u, _m) + 1, TextCodec::Format(),
+                             [&](size_t i, TextCodec::Text& text) {
+            for (size_t k = rowPtr[i]; k < rowPtr[i + 1]; ++k) {
+                text.value(i);
+                text.put(' ');
+                text.value(colIdx[k]);
+                text.put(' ');
+                text.value(values[k]);
+                text.put('\n');
+            }
+        });
+
+        outfile.close();
+    }
+
+    // Двоичный импорт: rowPtr, colIdx и values читаются разделами и проверяются
+    // конструктором CSR
+    void importFromBinary(const std::string& filename) override {
+        MatrixFile::Reader reader(filename);
+        const MatrixFileHeader& h = reader.header();
+        MatrixFile::check<T>(h, static_cast<uint32_t>(MatrixStructure::Sparse));
+        unsigned m = MatrixFile::dimension(h.rows);
+        unsigned n = MatrixFile::dimension(h.cols);
+
+        // Каждый раздел выделяется только после проверки, что он есть в файле
+        std::vector<uint64_t> pointers(reader.expect<uint64_t>(static_cast<uint64_t>(m) + 1));
+        reader.section(pointers.data(), pointers.size());
+        std::vector<unsigned> columns(reader.expect<unsigned>(h.params[0]));
+        reader.section(columns.data(), columns.size());
+        std::vector<T> nonZeros(reader.expect<T>(h.params[0]));
+        reader.section(nonZeros.data(), nonZeros.size());
+        *this = MatrixSparse<T>(m, n, std::vector<size_t>(pointers.begin(), pointers.end()),
+                                std::move(columns), std::move(nonZeros));
+    }
+
+    // Двоичный экспорт; params[0] - число ненулевых
+    void exportToBinary(const std::string& filename) const override {
+        static_assert(sizeof(unsigned) == sizeof(uint32_t), "colIdx хранится в файле как uint32.");
+        MatrixFileHeader h = MatrixFile::header<T>(static_cast<uint32_t>(MatrixStructure::Sparse), _m, _n);
+        h.params[0] = values.size();
+        MatrixFile::Writer writer(filename, h);
+        std::vector<uint64_t> pointers(rowPtr.begin(), rowPtr.end());
+        writer.section(pointers.data(), pointers.size());
+        writer.section(colIdx.data(), colIdx.size());
+        writer.section(values.data(), values.size());
+        writer.close();
+    }
+
+    // Метод для печати матрицы
+    void print(std::ostream& os = std::cout) const override {
+        TextCodec::writeRows(os, _m, _n, TextCodec::Format::of(os), [&](size_t i, TextCodec::Text& text) {
+            size_t k = rowPtr[i];
+            for (unsigned j = 0; j < _n; ++j) {
+                text.value(k < rowPtr[i + 1] && colIdx[k] == j ? values[k++] : T());
+                text.put('\t');
+            }
+            text.put('\n');
+        });
+    }
+
+private:
+    // this + sign * other для неразреженной other: плотная копия other, в которую
+    // добавляются только ненулевые элементы this
+    MatrixDense<T>* addToDense(const Matrix<T>& other, T sign) const {
+        MatrixDense<T>* result = new MatrixDense<T>(_m, _n);
+        if (_m == 0 || _n == 0) return result;
+        other.copyTile(0, 0, _m, _n, &(*result)(0, 0), _n);
+        forRowStrips(_m, 0, [&](unsigned begin, unsigned end) {
+            for (unsigned i = begin; i < end; ++i) {
+                T* row = &(*result)(i, 0);
+                if (sign != T(1)) {
+                    for (unsigned j = 0; j < _n; ++j) row[j] = sign * row[j];
+                }
+                for (size_t k = rowPtr[i]; k < rowPtr[i + 1]; ++k) row[colIdx[k]] += values[k];
+            }
+        });
+        return result;
+    }
+};
+
+#endif
@@ -0,0 +1,356 @@
+#ifndef OUTOFCORE_H
+#define OUTOFCORE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <future>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Gemm.h"
+#include "MatrixBlock.h"
+#include "MatrixFile.h"
+#include "ThreadPool.h"
+
+// Блочная матрица на диске: каталог с файлом matrix.bin (заголовок MatrixFile с
+// разбиением на блоки, без данных) и файлами плиток tile_<bi>_<bj>.bin. Каждая
+// плитка - двоичный файл MatrixDense (её можно открыть MatrixDense::mapFile),
+// отсутствующий файл - нулевая плитка, как нулевой блок MatrixBlock.
+template <typename T>
+class TileStore {
+public:
+    // Новая матрица из нулевых плиток; старые плитки в каталоге удаляются
+    static TileStore<T> create(const std::string& directory, unsigned blockRows, unsigned blockCols,
+                               unsigned blockSizeM, unsigned blockSizeN) {
+        namespace fs = std::filesystem;
+        fs::create_directories(directory);
+        for (const fs::directory_entry& entry : fs::directory_iterator(directory)) {
+            std::string name = entry.path().filename().string();
+            if (name.rfind("tile_", 0) == 0 && entry.path().extension() == ".bin") fs::remove(entry.path());
+        }
+
+        TileStore<T> store(directory, blockRows, blockCols, blockSizeM, blockSizeN);
+        MatrixFileHeader h = MatrixFile::header<T>(static_cast<uint32_t>(MatrixStructure::Block),
+                                                   store.rows(), store.cols());
+        h.params[0] = blockRows;
+        h.params[1] = blockCols;
+        h.params[2] = blockSizeM;
+        h.params[3] = blockSizeN;
+        MatrixFile::Writer writer(store.headerPath(), h);
+        writer.close();
+        return store;
+    }
+
+    static TileStore<T> open(const std::string& directory) {
+        MatrixFile::Reader reader((std::filesystem::path(directory) / "matrix.bin").string());
+        const MatrixFileHeader& h = reader.header();
+        MatrixFile::check<T>(h, static_cast<uint32_t>(MatrixStructure::Block));
+        TileStore<T> store(directory, MatrixFile::dimension(h.params[0]), MatrixFile::dimension(h.params[1]),
+                           MatrixFile::dimension(h.params[2]), MatrixFile::dimension(h.params[3]));
+        if (h.rows != store.rows() || h.cols != store.cols()) {
+            throw std::runtime_error("Некорректный заголовок двоичного файла матрицы.");
+        }
+        for (unsigned bi = 0; bi < store._blockRows; ++bi) {
+            for (unsigned bj = 0; bj < store._blockCols; ++bj) {
+                store.present[store.index(bi, bj)] = std::filesystem::exists(store.tilePath(bi, bj));
+            }
+        }
+        return store;
+    }
+
+    // Блоки MatrixBlock в плитки на диске; нулевые блоки файлов не получают
+    static TileStore<T> fromBlock(const MatrixBlock<T>& matrix, const std::string& directory) {
+        TileStore<T> store = create(directory, matrix.blockRows(), matrix.blockCols(),
+                                    matrix.blockSizeM(), matrix.blockSizeN());
+        for (unsigned bi = 0; bi < store._blockRows; ++bi) {
+            for (unsigned bj = 0; bj < store._blockCols; ++bj) {
+                if (const T* block = matrix.block(bi, bj)) store.writeTile(bi, bj, block);
+            }
+        }
+        return store;
+    }
+
+    // Вся матрица в память
+    MatrixBlock<T> toBlock() const {
+        MatrixBlock<T> matrix(_blockRows, _blockCols, _blockSizeM, _blockSizeN);
+        for (unsigned bi = 0; bi < _blockRows; ++bi) {
+            for (unsigned bj = 0; bj < _blockCols; ++bj) {
+                if (!hasTile(bi, bj)) continue;
+                auto block = std::make_shared<MatrixDense<T>>(_blockSizeM, _blockSizeN);
+                readTile(bi, bj, &(*block)(0, 0));
+                matrix.setBlock(bi, bj, block);
+            }
+        }
+        return matrix;
+    }
+
+    const std::string& directory() const { return _directory; }
+    unsigned blockRows() const { return _blockRows; }
+    unsigned blockCols() const { return _blockCols; }
+    unsigned blockSizeM() const { return _blockSizeM; }
+    unsigned blockSizeN() const { return _blockSizeN; }
+    uint64_t rows() const { return static_cast<uint64_t>(_blockRows) * _blockSizeM; }
+    uint64_t cols() const { return static_cast<uint64_t>(_blockCols) * _blockSizeN; }
+    size_t tileElems() const { return static_cast<size_t>(_blockSizeM) * _blockSizeN; }
+
+    bool hasTile(unsigned bi, unsigned bj) const { return present[index(bi, bj)]; }
+
+    // Плитка в out (tileElems элементов); нулевая плитка - нули
+    void readTile(unsigned bi, unsigned bj, T* out) const {
+        if (!hasTile(bi, bj)) {
+            std::fill(out, out + tileElems(), T());
+            return;
+        }
+        MatrixFile::Reader reader(tilePath(bi, bj));
+        const MatrixFileHeader& h = reader.header();
+        MatrixFile::check<T>(h, static_cast<uint32_t>(MatrixStructure::Dense));
+        if (h.rows != _blockSizeM || h.cols != _blockSizeN) {
+            throw std::runtime_error("Размер плитки в файле не соответствует размеру блока матрицы.");
+        }
+        reader.section(out, tileElems());
+    }
+
+    void writeTile(unsigned bi, unsigned bj, const T* data) {
+        MatrixFile::Writer writer(tilePath(bi, bj), MatrixFile::header<T>(
+            static_cast<uint32_t>(MatrixStructure::Dense), _blockSizeM, _blockSizeN));
+        writer.section(data, tileElems());
+        writer.close();
+        present[index(bi, bj)] = 1;
+    }
+
+    void removeTile(unsigned bi, unsigned bj) {
+        std::filesystem::remove(tilePath(bi, bj));
+        present[index(bi, bj)] = 0;
+    }
+
+private:
+    std::string _directory;
+    unsigned _blockRows, _blockCols;
+    unsigned _blockSizeM, _blockSizeN;
+    std::vector<char> present;    // Есть ли файл плитки, по номеру bi * blockCols + bj
+
+    TileStore(const std::string& directory, unsigned blockRows, unsigned blockCols,
+              unsigned blockSizeM, unsigned blockSizeN)
+        : _directory(directory), _blockRows(blockRows), _blockCols(blockCols),
+          _blockSizeM(blockSizeM), _blockSizeN(blockSizeN),
+          present(static_cast<size_t>(blockRows) * blockCols, 0) {}
+
+    size_t index(unsigned bi, unsigned bj) const { return static_cast<size_t>(bi) * _blockCols + bj; }
+
+    std::string headerPath() const { return (std::filesystem::path(_directory) / "matrix.bin").string(); }
+
+    std::string tilePath(unsigned bi, unsigned bj) const {
+        return (std::filesystem::path(_directory) /
+                ("tile_" + std::to_string(bi) + "_" + std::to_string(bj) + ".bin")).string();
+    }
+};
+
+// Умножение матриц, которые не помещаются в память: C = A * B над TileStore.
+//
+// В памяти держится панель результата p x q плиток. Для панели перебираются k:
+// шаг загружает плитки A(i, k) панельных строк и B(k, j) панельных столбцов,
+// и каждая плитка A участвует в q произведениях, каждая B - в p. Так A читается
+// с диска ceil(NB / q) раз, B - ceil(MB / p) раз; p и q выбираются по бюджету
+// памяти так, чтобы суммарное чтение было наименьшим. Пока считается шаг, второй
+// поток читает плитки следующего шага, поэтому в памяти панель и два шага:
+//   p * q * |C| + 2 * (p * |A| + q * |B|) <= memoryBudget.
+// Направление k меняется от панели к панели, панели обходятся змейкой: первый
+// шаг новой панели совпадает с последним шагом предыдущей по одному из
+// множителей, и эти плитки не читаются повторно. Нулевые плитки не читаются и не
+// умножаются, нулевые плитки результата не записываются.
+template <typename T>
+struct OutOfCoreGemm {
+    struct Stats {
+        unsigned panelRows = 0, panelCols = 0;    // p и q
+        size_t tileReads = 0, tileWrites = 0;
+        size_t bytesRead = 0, bytesWritten = 0;
+    };
+
+    // Результат в каталоге directory (создается заново); numThreads = 0 - все потоки общего пула
+    static TileStore<T> multiply(const TileStore<T>& A, const TileStore<T>& B, const std::string& directory,
+                                 size_t memoryBudget, unsigned numThreads = 0, Stats* stats = nullptr) {
+        if (A.blockCols() != B.blockRows() || A.blockSizeN() != B.blockSizeM()) {
+            throw std::invalid_argument("Разбиения блочных матриц не согласованы для умножения.");
+        }
+        namespace fs = std::filesystem;
+        fs::path target = fs::weakly_canonical(directory);
+        if (target == fs::weakly_canonical(A.directory()) || target == fs::weakly_canonical(B.directory())) {
+            throw std::invalid_argument("Результат нельзя записывать в каталог множителя.");
+        }
+
+        Stats local;
+        if (!stats) stats = &local;
+        *stats = Stats();
+        // Плитки нулевого размера: результат из нулевых плиток, панель не выбирается
+        if (A.tileElems() == 0 || B.tileElems() == 0) {
+            return TileStore<T>::create(directory, A.blockRows(), B.blockCols(), A.blockSizeM(), B.blockSizeN());
+        }
+        choosePanel(A, B, memoryBudget, stats->panelRows, stats->panelCols);
+
+        TileStore<T> C = TileStore<T>::create(directory, A.blockRows(), B.blockCols(), A.blockSizeM(), B.blockSizeN());
+        std::vector<Step> steps = schedule(A.blockRows(), B.blockCols(), A.blockCols(),
+                                           stats->panelRows, stats->panelCols);
+        if (steps.empty()) return C;
+
+        ThreadPool& pool = ThreadPool::shared();
+        if (numThreads == 0) numThreads = pool.size();
+        unsigned m = A.blockSizeM(), n = B.blockSizeN(), k = A.blockSizeN();
+        size_t cElems = C.tileElems();
+        std::vector<std::vector<T>> panel(static_cast<size_t>(stats->panelRows) * stats->panelCols,
+                                          std::vector<T>(cElems));
+        std::vector<char> touched(panel.size(), 0);
+
+        // current объявлен раньше next: пока идет загрузка, она читает current
+        Loaded current;
+        std::future<Loaded> next = std::async(std::launch::async, [&] { return load(A, B, steps[0], nullptr, *stats); });
+        for (size_t s = 0; s < steps.size(); ++s) {
+            current = next.get();
+            if (s + 1 < steps.size()) {
+                next = std::async(std::launch::async, [&, s] { return load(A, B, steps[s + 1], &current, *stats); });
+            }
+            const Step& step = steps[s];
+            unsigned p = step.rowEnd - step.rowBegin;
+            unsigned q = step.colEnd - step.colBegin;
+
+            std::vector<unsigned> pairs;
+            for (unsigned a = 0; a < p; ++a) {
+                for (unsigned b = 0; b < q; ++b) {
+                    if (current.a[a] && current.b[b]) pairs.push_back(a * q + b);
+                }
+            }
+            unsigned gemmThreads = std::max(1u, numThreads / std::max<unsigned>(1, static_cast<unsigned>(pairs.size())));
+            pool.parallelFor(static_cast<unsigned>(pairs.size()), numThreads, [&](unsigned t) {
+                unsigned a = pairs[t] / q, b = pairs[t] % q;
+                T* c = panel[pairs[t]].data();
+                if (!touched[pairs[t]]) std::fill(c, c + cElems, T());
+                touched[pairs[t]] = 1;
+                Gemm<T>::multiply(m, n, k, T(1), current.a[a]->data(), k, current.b[b]->data(), n,
+                                  T(1), c, n, gemmThreads);
+            });
+
+            // Панель готова: ненулевые плитки на диск, пока читается первый шаг следующей
+            if (step.last) {
+                for (unsigned a = 0; a < p; ++a) {
+                    for (unsigned b = 0; b < q; ++b) {
+                        if (!touched[a * q + b]) continue;
+                        C.writeTile(step.rowBegin + a, step.colBegin + b, panel[a * q + b].data());
+                        touched[a * q + b] = 0;
+                        ++stats->tileWrites;
+                        stats->bytesWritten += cElems * sizeof(T);
+                    }
+                }
+            }
+        }
+        return C;
+    }
+
+private:
+    // Шаг: панель [rowBegin, rowEnd) x [colBegin, colEnd) плиток результата и номер k
+    struct Step {
+        unsigned rowBegin, rowEnd, colBegin, colEnd, k;
+        bool last;    // Последний шаг панели
+    };
+
+    // Плитки шага: a[i] - A(rowBegin + i, k), b[j] - B(k, colBegin + j), nullptr - не нужна
+    struct Loaded {
+        const Step* step = nullptr;
+        std::vector<std::shared_ptr<const std::vector<T>>> a, b;
+    };
+
+    static void choosePanel(const TileStore<T>& A, const TileStore<T>& B, size_t memoryBudget,
+                            unsigned& panelRows, unsigned& panelCols) {
+        size_t aBytes = A.tileElems() * sizeof(T);
+        size_t bBytes = B.tileElems() * sizeof(T);
+        size_t cBytes = static_cast<size_t>(A.blockSizeM()) * B.blockSizeN() * sizeof(T);
+        unsigned MB = A.blockRows(), NB = B.blockCols(), KB = A.blockCols();
+        double best = std::numeric_limits<double>::infinity();
+        panelRows = panelCols = 0;
+        for (unsigned p = 1; p <= std::max(1u, MB); ++p) {
+            if (2 * p * aBytes >= memoryBudget) break;
+            size_t q = (memoryBudget - 2 * p * aBytes) / (p * cBytes + 2 * bBytes);
+            q = std::min<size_t>(q, std::max(1u, NB));
+            if (q == 0) continue;
+            // Байты, прочитанные за все умножение
+            double reads = double((NB + q - 1) / q) * MB * KB * aBytes + double((MB + p - 1) / p) * KB * NB * bBytes;
+            if (reads < best) {
+                best = reads;
+                panelRows = p;
+                panelCols = static_cast<unsigned>(q);
+            }
+        }
+        if (panelRows == 0) {
+            throw std::invalid_argument("Бюджет памяти меньше одной плитки результата и двух шагов загрузки.");
+        }
+    }
+
+    // Панели змейкой по строкам панелей, k в каждой панели - в обратном к предыдущей порядке
+    static std::vector<Step> schedule(unsigned MB, unsigned NB, unsigned KB, unsigned p, unsigned q) {
+        std::vector<Step> steps;
+        if (KB == 0) return steps;
+        unsigned panelRowCount = (MB + p - 1) / p, panelColCount = (NB + q - 1) / q;
+        bool kForward = true;
+        for (unsigned pi = 0; pi < panelRowCount; ++pi) {
+            for (unsigned c = 0; c < panelColCount; ++c) {
+                unsigned pj = pi % 2 == 0 ? c : panelColCount - 1 - c;
+                for (unsigned t = 0; t < KB; ++t) {
+                    steps.push_back({pi * p, std::min(MB, (pi + 1) * p), pj * q, std::min(NB, (pj + 1) * q),
+                                     kForward ? t : KB - 1 - t, t + 1 == KB});
+                }
+                kForward = !kForward;
+            }
+        }
+        return steps;
+    }
+
+    // Чтение плиток шага; плитки, уже загруженные предыдущим шагом, берутся из него.
+    // Плитка A не читается, если в шаге нет ни одной ненулевой плитки B, и наоборот
+    static Loaded load(const TileStore<T>& A, const TileStore<T>& B, const Step& step,
+                       const Loaded* previous, Stats& stats) {
+        Loaded loaded;
+        loaded.step = &step;
+        unsigned p = step.rowEnd - step.rowBegin, q = step.colEnd - step.colBegin;
+        loaded.a.resize(p);
+        loaded.b.resize(q);
+        bool anyA = false, anyB = false;
+        for (unsigned i = step.rowBegin; i < step.rowEnd; ++i) anyA = anyA || A.hasTile(i, step.k);
+        for (unsigned j = step.colBegin; j < step.colEnd; ++j) anyB = anyB || B.hasTile(step.k, j);
+        if (!anyA || !anyB) return loaded;
+
+        const Step* prev = previous ? previous->step : nullptr;
+        auto read = [&](const TileStore<T>& store, unsigned bi, unsigned bj) {
+            auto tile = std::make_shared<std::vector<T>>(store.tileElems());
+            store.readTile(bi, bj, tile->data());
+            ++stats.tileReads;
+            stats.bytesRead += store.tileElems() * sizeof(T);
+            return std::shared_ptr<const std::vector<T>>(std::move(tile));
+        };
+        for (unsigned a = 0; a < p; ++a) {
+            unsigned i = step.rowBegin + a;
+            if (!A.hasTile(i, step.k)) continue;
+            if (prev && prev->k == step.k && i >= prev->rowBegin && i < prev->rowEnd &&
+                previous->a[i - prev->rowBegin]) {
+                loaded.a[a] = previous->a[i - prev->rowBegin];
+            } else {
+                loaded.a[a] = read(A, i, step.k);
+            }
+        }
+        for (unsigned b = 0; b < q; ++b) {
+            unsigned j = step.colBegin + b;
+            if (!B.hasTile(step.k, j)) continue;
+            if (prev && prev->k == step.k && j >= prev->colBegin && j < prev->colEnd &&
+                previous->b[j - prev->colBegin]) {
+                loaded.b[b] = previous->b[j - prev->colBegin];
+            } else {
+                loaded.b[b] = read(B, step.k, j);
+            }
+        }
+        return loaded;
+    }
+};
+
+#endif
@@ -0,0 +1,249 @@
+#ifndef STRASSEN_H
+#define STRASSEN_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "Gemm.h"
+#include "ThreadPool.h"
+
+// Умножение квадратных матриц по Штрассену в варианте Винограда:
+// 7 умножений и 15 сложений половинных блоков вместо 8 умножений, итого
+// O(n^2.807). Ниже порога crossover рекурсия переходит на блочный Gemm.
+// Нечетный размер обрабатывается отщеплением последней строки и столбца,
+// которые досчитываются тем же Gemm. Блоки A и B адресуются через указатель
+// и ведущую размерность, без копирования; временные суммы и 7 произведений
+// берутся из рабочей области, выделенной один раз на вызов из пула буферов.
+// На верхнем уровне 7 произведений считаются параллельно.
+//
+// Погрешность. Для обычного умножения ошибка покомпонентная:
+// |C - fl(C)| <= n u |A| |B|, где u - машинная точность. Штрассен дает только
+// нормовую оценку |C - fl(C)|_max <= f(n) u |A|_max |B|_max, где для варианта
+// Винограда f(n) ~ (n / n0)^log2(18) * n0^2, n0 - порог перехода на Gemm;
+// каждый уровень рекурсии добавляет множитель порядка 18/4 к оценке. На практике
+// это теряет 1-2 десятичных знака на уровень для элементов, малых по сравнению
+// с нормой произведения, поэтому путь включается явно при вызове. Для целых типов
+// результат точен, если промежуточные суммы блоков не переполняются.
+template <typename T>
+struct Strassen {
+    // Размер, начиная с которого рекурсия выгоднее Gemm (подбирается tuneCrossover).
+    // Вызов читает порог один раз, поэтому рабочая область и рекурсия согласованы
+    // даже при одновременной настройке
+    static inline std::atomic<unsigned> crossover{512};
+
+    // C = A * B для матриц n x n; numThreads = 0 - все потоки общего пула
+    static void multiply(unsigned n, const T* A, unsigned lda, const T* B, unsigned ldb,
+                         T* C, unsigned ldc, unsigned numThreads = 0) {
+        run(n, A, lda, B, ldb, C, ldc, numThreads, crossover.load(std::memory_order_relaxed));
+    }
+
+    // Подбор порога: удваиваем размер, пока один уровень рекурсии медленнее Gemm
+    static unsigned tuneCrossover(unsigned maxSize = 2048, unsigned numThreads = 0) {
+        unsigned found = maxSize;
+        for (unsigned n = 128; n <= maxSize; n *= 2) {
+            std::vector<T> A(static_cast<size_t>(n) * n, T(1)), B(A), C(A);
+            auto time = [&](auto func) {
+                auto start = std::chrono::high_resolution_clock::now();
+                func();
+                return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+            };
+            double gemmTime = time([&]() {
+                Gemm<T>::multiply(n, n, n, T(1), A.data(), n, B.data(), n, T(), C.data(), n, numThreads);
+            });
+            // Кандидат передается явно: общий порог меняется только в конце
+            double strassenTime = time([&]() {
+                run(n, A.data(), n, B.data(), n, C.data(), n, numThreads, n / 2);
+            });
+            if (strassenTime < gemmTime) {
+                found = n / 2;
+                break;
+            }
+        }
+        crossover.store(found, std::memory_order_relaxed);
+        return found;
+    }
+
+private:
+    // Умножение с порогом cutoff вместо общего crossover
+    static void run(unsigned n, const T* A, unsigned lda, const T* B, unsigned ldb,
+                    T* C, unsigned ldc, unsigned numThreads, unsigned cutoff) {
+        if (numThreads == 0) numThreads = ThreadPool::shared().size();
+        bool parallel = numThreads > 1;
+        Lease workspace(workspaceSize(n, cutoff, parallel));
+        recurse(n, A, lda, B, ldb, C, ldc, workspace.data(), numThreads, cutoff, parallel);
+    }
+
+    // Буферы рабочих областей переиспользуются между вызовами
+    class Lease {
+    public:
+        explicit Lease(size_t size) {
+            std::lock_guard<std::mutex> lock(poolMutex());
+            auto& free = freeBuffers();
+            auto it = std::find_if(free.begin(), free.end(),
+                                   [size](const std::vector<T>& b) { return b.size() >= size; });
+            if (it != free.end()) {
+                buffer = std::move(*it);
+                free.erase(it);
+            }
+            if (buffer.size() < size) buffer.resize(size);
+        }
+
+        ~Lease() {
+            std::lock_guard<std::mutex> lock(poolMutex());
+            freeBuffers().push_back(std::move(buffer));
+        }
+
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+
+        T* data() { return buffer.data(); }
+
+    private:
+        std::vector<T> buffer;
+    };
+
+    static std::mutex& poolMutex() {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+    static std::vector<std::vector<T>>& freeBuffers() {
+        static std::vector<std::vector<T>> buffers;
+        return buffers;
+    }
+
+    // 8 сумм S1..S4, T1..T4 и 7 произведений размера h x h на уровень;
+    // при параллельном уровне каждое из 7 произведений получает свою часть
+    static size_t workspaceSize(unsigned n, unsigned cutoff, bool parallel) {
+        if (n <= cutoff || n < 2) return 0;
+        if (n % 2 == 1) return workspaceSize(n - 1, cutoff, parallel);
+        size_t h = n / 2;
+        return 15 * h * h + (parallel ? 7 : 1) * workspaceSize(n / 2, cutoff, false);
+    }
+
+    static void recurse(unsigned n, const T* A, unsigned lda, const T* B, unsigned ldb,
+                        T* C, unsigned ldc, T* work, unsigned numThreads, unsigned cutoff, bool parallel) {
+        if (n <= cutoff || n < 2) {
+            Gemm<T>::multiply(n, n, n, T(1), A, lda, B, ldb, T(), C, ldc, numThreads);
+            return;
+        }
+        if (n % 2 == 1) {
+            unsigned e = n - 1;
+            recurse(e, A, lda, B, ldb, C, ldc, work, numThreads, cutoff, parallel);
+            // C[0:e, 0:e] += A[0:e, e] * B[e, 0:e], затем последние столбец и строка C
+            Gemm<T>::multiply(e, e, 1, T(1), A + e, lda, B + static_cast<size_t>(e) * ldb, ldb,
+                              T(1), C, ldc, numThreads);
+            Gemm<T>::multiply(e, 1, n, T(1), A, lda, B + e, ldb, T(), C + e, ldc, numThreads);
+            Gemm<T>::multiply(1, n, n, T(1), A + static_cast<size_t>(e) * lda, lda, B, ldb,
+                              T(), C + static_cast<size_t>(e) * ldc, ldc, numThreads);
+            return;
+        }
+
+        unsigned h = n / 2;
+        size_t hh = static_cast<size_t>(h) * h;
+        const T* A11 = A;
+        const T* A12 = A + h;
+        const T* A21 = A + static_cast<size_t>(h) * lda;
+        const T* A22 = A21 + h;
+        const T* B11 = B;
+        const T* B12 = B + h;
+        const T* B21 = B + static_cast<size_t>(h) * ldb;
+        const T* B22 = B21 + h;
+
+        T* S1 = work;
+        T* S2 = S1 + hh;
+        T* S3 = S2 + hh;
+        T* S4 = S3 + hh;
+        T* T1 = S4 + hh;
+        T* T2 = T1 + hh;
+        T* T3 = T2 + hh;
+        T* T4 = T3 + hh;
+        T* P = T4 + hh;          // P1..P7 подряд
+        T* rest = P + 7 * hh;
+
+        combine(h, A21, lda, A22, lda, T(1), S1, h);
+        combine(h, S1, h, A11, lda, T(-1), S2, h);
+        combine(h, A11, lda, A21, lda, T(-1), S3, h);
+        combine(h, A12, lda, S2, h, T(-1), S4, h);
+        combine(h, B12, ldb, B11, ldb, T(-1), T1, h);
+        combine(h, B22, ldb, T1, h, T(-1), T2, h);
+        combine(h, B22, ldb, B12, ldb, T(-1), T3, h);
+        combine(h, T2, h, B21, ldb, T(-1), T4, h);
+
+        struct Product {
+            const T* left;
+            unsigned ldl;
+            const T* right;
+            unsigned ldr;
+        };
+        const Product products[7] = {
+            {A11, lda, B11, ldb}, {A12, lda, B21, ldb}, {S4, h, B22, ldb}, {A22, lda, T4, h},
+            {S1, h, T1, h}, {S2, h, T2, h}, {S3, h, T3, h}};
+
+        if (parallel) {
+            // Каждое произведение - отдельное задание пула, рекурсия внутри последовательная,
+            // а потоки сверх семи достаются Gemm на листьях
+            size_t childWork = workspaceSize(h, cutoff, false);
+            unsigned childThreads = std::max(1u, numThreads / 7);
+            ThreadPool::shared().parallelFor(7, numThreads, [&](unsigned p) {
+                recurse(h, products[p].left, products[p].ldl, products[p].right, products[p].ldr,
+                        P + p * hh, h, rest + p * childWork, childThreads, cutoff, false);
+            });
+        } else {
+            for (unsigned p = 0; p < 7; ++p) {
+                recurse(h, products[p].left, products[p].ldl, products[p].right, products[p].ldr,
+                        P + p * hh, h, rest, numThreads, cutoff, false);
+            }
+        }
+
+        // C11 = P1 + P2, C12 = P1 + P6 + P5 + P3, C21 = P1 + P6 + P7 - P4, C22 = P1 + P6 + P7 + P5
+        const T* P1 = P;
+        const T* P2 = P1 + hh;
+        const T* P3 = P2 + hh;
+        const T* P4 = P3 + hh;
+        const T* P5 = P4 + hh;
+        const T* P6 = P5 + hh;
+        const T* P7 = P6 + hh;
+        T* C11 = C;
+        T* C12 = C + h;
+        T* C21 = C + static_cast<size_t>(h) * ldc;
+        T* C22 = C21 + h;
+        for (unsigned i = 0; i < h; ++i) {
+            size_t r = static_cast<size_t>(i) * h;
+            T* c11 = C11 + static_cast<size_t>(i) * ldc;
+            T* c12 = C12 + static_cast<size_t>(i) * ldc;
+            T* c21 = C21 + static_cast<size_t>(i) * ldc;
+            T* c22 = C22 + static_cast<size_t>(i) * ldc;
+            for (unsigned j = 0; j < h; ++j) {
+                T u2 = P1[r + j] + P6[r + j];
+                T u3 = u2 + P7[r + j];
+                c11[j] = P1[r + j] + P2[r + j];
+                c12[j] = u2 + P5[r + j] + P3[r + j];
+                c21[j] = u3 - P4[r + j];
+                c22[j] = u3 + P5[r + j];
+            }
+        }
+    }
+
+    // out = X + sign * Y для блоков h x h
+    static void combine(unsigned h, const T* X, unsigned ldx, const T* Y, unsigned ldy,
+                        T sign, T* out, unsigned ldo) {
+        for (unsigned i = 0; i < h; ++i) {
+            const T* x = X + static_cast<size_t>(i) * ldx;
+            const T* y = Y + static_cast<size_t>(i) * ldy;
+            T* o = out + static_cast<size_t>(i) * ldo;
+            if (sign == T(1)) {
+                for (unsigned j = 0; j < h; ++j) o[j] = x[j] + y[j];
+            } else {
+                for (unsigned j = 0; j < h; ++j) o[j] = x[j] - y[j];
+            }
+        }
+    }
+};
+
+#endif
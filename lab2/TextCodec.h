@@ -0,0 +1,320 @@
+#ifndef TEXTCODEC_H
+#define TEXTCODEC_H
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "ThreadPool.h"
+
+// Текстовый формат матриц без потоковых операторов. Потоки >> и << разбирают и
+// печатают числа по одному через локаль и виртуальные вызовы буфера, что дает
+// единицы МБ/с. Здесь файл читается большими кусками в свой буфер, числа
+// разбираются std::from_chars, а печатаются std::to_chars в буферы, которые
+// уходят в поток одним write. Большие куски делятся по границам строк и
+// разбираются (и печатаются) параллельно потоками общего пула.
+// Разметка файлов не меняется: числа разделяются любыми пробельными символами.
+struct TextCodec {
+    static bool isSpace(char c) {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+    }
+
+    // Запись числа. По умолчанию плавающие пишутся кратчайшей записью, которая
+    // читается обратно без потерь; of(os) - как напечатал бы поток os
+    // (точность и fixed/scientific, по умолчанию %g с 6 знаками)
+    class Format {
+    public:
+        Format() : precision(-1), style(std::chars_format::general) {}
+
+        static Format of(const std::ostream& os) {
+            Format format;
+            format.precision = static_cast<int>(os.precision());
+            std::ios::fmtflags field = os.flags() & std::ios::floatfield;
+            if (field == std::ios::fixed) format.style = std::chars_format::fixed;
+            else if (field == std::ios::scientific) format.style = std::chars_format::scientific;
+            return format;
+        }
+
+        template <typename U>
+        char* put(char* first, char* last, U value) const {
+            std::to_chars_result result;
+            if constexpr (std::is_floating_point_v<U>) {
+                result = precision < 0 ? std::to_chars(first, last, value)
+                                       : std::to_chars(first, last, value, style, precision);
+            } else {
+                result = std::to_chars(first, last, value);
+            }
+            return result.ptr;
+        }
+
+        // Наибольшая длина записи числа типа U
+        template <typename U>
+        size_t maxChars() const {
+            if constexpr (std::is_floating_point_v<U>) {
+                return 32 + (style == std::chars_format::fixed ? 310 : 0) + std::max(precision, 0);
+            } else {
+                return 24;
+            }
+        }
+
+    private:
+        int precision;
+        std::chars_format style;
+    };
+
+    // Растущий буфер текста одного задания печати
+    class Text {
+    public:
+        explicit Text(Format format = Format()) : format(format) {}
+
+        template <typename U>
+        void value(U x) {
+            char* first = reserve(format.maxChars<U>());
+            length = static_cast<size_t>(format.put(first, buffer.data() + buffer.size(), x) - buffer.data());
+        }
+
+        void put(char c) {
+            *reserve(1) = c;
+            ++length;
+        }
+
+        void put(const char* s) {
+            size_t n = std::strlen(s);
+            std::memcpy(reserve(n), s, n);
+            length += n;
+        }
+
+        const char* data() const { return buffer.data(); }
+        size_t size() const { return length; }
+        void clear() { length = 0; }
+
+    private:
+        Format format;
+        std::string buffer;
+        size_t length = 0;
+
+        char* reserve(size_t n) {
+            if (length + n > buffer.size()) buffer.resize(std::max(2 * buffer.size(), length + n));
+            return buffer.data() + length;
+        }
+    };
+
+    // Печать count строк: row(i, text) дописывает строку i в text. Строки идут
+    // пачками; пачка делится на задания со своими буферами, задания печатают
+    // параллельно, буферы пишутся в os по порядку. rowElems - примерное число
+    // чисел в строке, по нему выбирается размер заданий. numThreads = 0 - все потоки
+    template <typename Row>
+    static void writeRows(std::ostream& os, size_t count, size_t rowElems, Format format, Row row,
+                          unsigned numThreads = 0) {
+        ThreadPool& pool = ThreadPool::shared();
+        if (numThreads == 0) numThreads = pool.size();
+        size_t rowsPerTask = std::max<size_t>(1, taskElems / std::max<size_t>(1, rowElems));
+        if (count <= rowsPerTask) numThreads = 1;
+        unsigned tasks = numThreads == 1 ? 1 : 4 * numThreads;
+
+        std::vector<Text> texts(tasks, Text(format));
+        for (size_t begin = 0; begin < count; begin += rowsPerTask * tasks) {
+            size_t batchEnd = std::min(count, begin + rowsPerTask * tasks);
+            pool.parallelFor(tasks, numThreads, [&](unsigned t) {
+                Text& text = texts[t];
+                text.clear();
+                size_t first = begin + t * rowsPerTask;
+                size_t last = std::min(batchEnd, first + rowsPerTask);
+                for (size_t i = first; i < last; ++i) row(i, text);
+            });
+            for (const Text& text : texts) {
+                os.write(text.data(), static_cast<std::streamsize>(text.size()));
+            }
+        }
+    }
+
+    // Чтение файла большими кусками. Первая строка читается line(), отдельные
+    // числа - value(), длинные последовательности чисел - values()
+    class Reader {
+    public:
+        explicit Reader(const std::string& filename, size_t capacity = size_t(1) << 24)
+            : in(filename, std::ios::binary), buffer(capacity) {
+            if (!in) {
+                throw std::runtime_error("Не удалось открыть файл для чтения.");
+            }
+        }
+
+        // Строка до перевода строки (как std::getline), без завершающего '\r'
+        std::string line() {
+            const char* newline;
+            while (!(newline = static_cast<const char*>(std::memchr(buffer.data() + pos, '\n', end - pos)))) {
+                if (!refill()) {
+                    newline = buffer.data() + end;
+                    break;
+                }
+            }
+            std::string result(static_cast<const char*>(buffer.data() + pos), newline);
+            pos = std::min(end, static_cast<size_t>(newline - buffer.data()) + 1);
+            if (!result.empty() && result.back() == '\r') result.pop_back();
+            return result;
+        }
+
+        template <typename U>
+        U value() {
+            for (;;) {
+                while (pos < end && isSpace(buffer[pos])) ++pos;
+                if (pos == end) {
+                    if (!refill()) throw std::runtime_error("Текстовый файл матрицы обрезан.");
+                    continue;
+                }
+                size_t tokenEnd = pos;
+                while (tokenEnd < end && !isSpace(buffer[tokenEnd])) ++tokenEnd;
+                if (tokenEnd == end && !eof) {
+                    refill();
+                    continue;
+                }
+                U x;
+                parse(buffer.data() + pos, buffer.data() + tokenEnd, x);
+                pos = tokenEnd;
+                return x;
+            }
+        }
+
+        // Следующие count чисел в out. Прочитанная часть буфера разбирается
+        // кусками, выровненными по строкам: сначала в каждом куске считаются
+        // числа, префиксные суммы дают место куска в out, затем куски
+        // разбираются параллельно
+        template <typename U>
+        void values(U* out, size_t count, unsigned numThreads = 0) {
+            while (count > 0) {
+                if (pos == end) {
+                    if (!refill()) throw std::runtime_error("Текстовый файл матрицы обрезан.");
+                    continue;
+                }
+                // Окно из целых чисел не длиннее, чем нужно для count чисел: конец
+                // сдвигается до пробельного символа, а если число может продолжаться
+                // за концом буфера - назад к началу этого числа
+                size_t cut = std::min(end, pos + count * maxTokenChars);
+                while (cut < end && !isSpace(buffer[cut])) ++cut;
+                if (cut == end && !eof) {
+                    while (cut > pos && !isSpace(buffer[cut - 1])) --cut;
+                    if (cut == pos) {
+                        refill();
+                        continue;
+                    }
+                }
+                const char* consumed;
+                size_t parsed = parseWindow(buffer.data() + pos, buffer.data() + cut, out, count, numThreads, consumed);
+                pos = static_cast<size_t>(consumed - buffer.data());
+                out += parsed;
+                count -= parsed;
+            }
+        }
+
+    private:
+        // Заведомо больше длины записи одного числа с разделителем
+        static constexpr size_t maxTokenChars = 64;
+
+        std::ifstream in;
+        std::vector<char> buffer;
+        size_t pos = 0, end = 0;
+        bool eof = false;
+
+        // Непрочитанный остаток - в начало буфера, дочитывание файла; false, если ничего не добавилось
+        bool refill() {
+            if (eof) return false;
+            std::memmove(buffer.data(), buffer.data() + pos, end - pos);
+            end -= pos;
+            pos = 0;
+            if (end == buffer.size()) buffer.resize(2 * buffer.size());
+            in.read(buffer.data() + end, static_cast<std::streamsize>(buffer.size() - end));
+            size_t got = static_cast<size_t>(in.gcount());
+            end += got;
+            if (got < buffer.size() - (end - got)) eof = true;
+            return got > 0;
+        }
+
+        template <typename U>
+        static void parse(const char* first, const char* last, U& x) {
+            if (first < last && *first == '+') ++first;    // Знак плюса принимает >>, но не from_chars
+            std::from_chars_result result = std::from_chars(first, last, x);
+            if (result.ec != std::errc() || result.ptr != last) {
+                throw std::runtime_error("Некорректное число в текстовом файле матрицы: " + std::string(first, last));
+            }
+        }
+
+        // Разбор не более count чисел из [first, last), где last - граница числа;
+        // consumed - позиция после последнего разобранного числа
+        template <typename U>
+        static size_t parseWindow(const char* first, const char* last, U* out, size_t count,
+                                  unsigned numThreads, const char*& consumed) {
+            ThreadPool& pool = ThreadPool::shared();
+            if (numThreads == 0) numThreads = pool.size();
+            if (static_cast<size_t>(last - first) < parallelChars) numThreads = 1;
+            if (numThreads == 1) return parseRange(first, last, out, count, consumed);
+
+            // Куски примерно равной длины, начало каждого - после перевода строки
+            unsigned chunks = 4 * numThreads;
+            std::vector<const char*> bounds(chunks + 1, last);
+            bounds[0] = first;
+            size_t step = static_cast<size_t>(last - first) / chunks;
+            for (unsigned c = 1; c < chunks; ++c) {
+                const char* from = std::max(bounds[c - 1], first + c * step);
+                const void* newline = std::memchr(from, '\n', static_cast<size_t>(last - from));
+                bounds[c] = newline ? static_cast<const char*>(newline) + 1 : last;
+            }
+
+            std::vector<size_t> offsets(chunks + 1, 0);
+            pool.parallelFor(chunks, numThreads, [&](unsigned c) {
+                size_t tokens = 0;
+                bool space = true;
+                for (const char* p = bounds[c]; p < bounds[c + 1]; ++p) {
+                    bool s = isSpace(*p);
+                    tokens += space && !s;
+                    space = s;
+                }
+                offsets[c + 1] = tokens;
+            });
+            for (unsigned c = 0; c < chunks; ++c) offsets[c + 1] += offsets[c];
+
+            std::vector<const char*> ends(chunks, nullptr);
+            pool.parallelFor(chunks, numThreads, [&](unsigned c) {
+                if (offsets[c] >= count) return;
+                parseRange(bounds[c], bounds[c + 1], out + offsets[c], count - offsets[c], ends[c]);
+            });
+            if (offsets[chunks] <= count) {
+                consumed = last;
+                return offsets[chunks];
+            }
+            unsigned c = static_cast<unsigned>(std::upper_bound(offsets.begin(), offsets.end(), count - 1) - offsets.begin()) - 1;
+            consumed = ends[c];
+            return count;
+        }
+
+        template <typename U>
+        static size_t parseRange(const char* p, const char* last, U* out, size_t count, const char*& consumed) {
+            size_t parsed = 0;
+            while (parsed < count) {
+                while (p < last && isSpace(*p)) ++p;
+                if (p == last) break;
+                const char* tokenEnd = p;
+                while (tokenEnd < last && !isSpace(*tokenEnd)) ++tokenEnd;
+                parse(p, tokenEnd, out[parsed++]);
+                p = tokenEnd;
+            }
+            consumed = parsed == count ? p : last;
+            return parsed;
+        }
+
+        // Ниже этой длины окна раздача заданий не окупается
+        static constexpr size_t parallelChars = size_t(1) << 20;
+    };
+
+private:
+    // Примерное число чисел на задание печати
+    static constexpr size_t taskElems = size_t(1) << 15;
+};
+
+#endif
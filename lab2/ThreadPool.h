@@ -0,0 +1,131 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Общий пул рабочих потоков для матричных операций: потоки создаются
+// один раз, а не на каждое умножение. Раздача заданий не выделяет памяти:
+// описание задания живет на стеке вызывающего, а очередь заранее зарезервирована.
+class ThreadPool {
+public:
+    explicit ThreadPool(unsigned numThreads) {
+        queue.reserve(static_cast<size_t>(numThreads) * 64);
+        for (unsigned i = 0; i < numThreads; ++i) {
+            workers.emplace_back([this]() { workerLoop(); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wakeup.notify_all();
+        for (auto& th : workers) th.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Пул на все аппаратные потоки
+    static ThreadPool& shared() {
+        static ThreadPool pool(std::max(1u, std::thread::hardware_concurrency()));
+        return pool;
+    }
+
+    unsigned size() const { return static_cast<unsigned>(workers.size()); }
+
+    // Выполняет func(i) для i из [0, count) не более чем в numThreads потоках
+    // (0 - во всех). Вызывающий поток тоже берет задания, а когда они кончаются,
+    // убирает из очереди еще не начатые места помощников и ждет только уже
+    // работающих, поэтому вложенный вызов из рабочего потока не блокируется.
+    template <typename Func>
+    void parallelFor(unsigned count, unsigned numThreads, Func&& func) {
+        if (count == 0) return;
+        if (numThreads == 0) numThreads = size();
+        unsigned helpers = std::min(numThreads, count) - 1;
+        if (helpers == 0) {
+            for (unsigned i = 0; i < count; ++i) func(i);
+            return;
+        }
+
+        using F = std::remove_reference_t<Func>;
+        Job job;
+        job.count = count;
+        job.context = const_cast<void*>(static_cast<const void*>(&func));
+        job.call = [](void* context, unsigned i) { (*static_cast<F*>(context))(i); };
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (unsigned h = 0; h < helpers; ++h) queue.push_back(&job);
+        }
+        if (helpers == 1) {
+            wakeup.notify_one();
+        } else {
+            wakeup.notify_all();
+        }
+
+        work(job);
+
+        std::unique_lock<std::mutex> lock(mutex);
+        queue.erase(std::remove(queue.begin(), queue.end(), &job), queue.end());
+        job.finished.wait(lock, [&job]() { return job.active == 0; });
+        if (job.error) std::rethrow_exception(job.error);
+    }
+
+private:
+    struct Job {
+        unsigned count = 0;
+        void* context = nullptr;
+        void (*call)(void*, unsigned) = nullptr;
+        std::atomic<unsigned> next{0};
+        unsigned active = 0;               // Помощники, взявшие задание (под mutex пула)
+        std::exception_ptr error;
+        std::condition_variable finished;
+    };
+
+    std::vector<std::thread> workers;
+    std::vector<Job*> queue;
+    std::mutex mutex;
+    std::condition_variable wakeup;
+    bool stopping = false;
+
+    void work(Job& job) {
+        for (;;) {
+            unsigned i = job.next.fetch_add(1, std::memory_order_relaxed);
+            if (i >= job.count) return;
+            try {
+                job.call(job.context, i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!job.error) job.error = std::current_exception();
+            }
+        }
+    }
+
+    void workerLoop() {
+        for (;;) {
+            Job* job;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wakeup.wait(lock, [this]() { return stopping || !queue.empty(); });
+                if (queue.empty()) return;
+                job = queue.back();
+                queue.pop_back();
+                ++job->active;
+            }
+            work(*job);
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--job->active == 0) job->finished.notify_all();
+        }
+    }
+};
+
+#endif
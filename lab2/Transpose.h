@@ -0,0 +1,168 @@
+#ifndef TRANSPOSE_H
+#define TRANSPOSE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "ThreadPool.h"
+
+// Транспонирование матриц в построчном хранении.
+//
+// Наивный цикл читает A по строкам, а пишет B с шагом в целую строку, поэтому
+// при больших размерах почти каждая запись - промах кэша. Здесь матрица делится
+// пополам по большей стороне, пока кусок не станет плиткой TILE x TILE
+// (кэш-независимая рекурсия: на каком-то уровне кусок помещается в любой уровень
+// кэша), а плитка транспонируется микроплитками MICRO x MICRO через локальный
+// массив: строки читаются и пишутся подряд, перестановку элементов внутри
+// микроплитки компилятор делает векторными перестановками регистров.
+// Параллельно верхний уровень режется на полосы по потокам общего пула.
+//
+// На месте: квадратная матрица - обменом симметричных плиток, прямоугольная -
+// обходом циклов перестановки индексов (1 бит дополнительной памяти на элемент).
+template <typename T>
+struct Transpose {
+    static constexpr unsigned MICRO = 8;
+    static constexpr unsigned TILE = 64;
+
+    // B = A^T, A - m x n с шагом строк lda, B - n x m с шагом ldb;
+    // numThreads = 0 - все потоки общего пула
+    static void outOfPlace(unsigned m, unsigned n, const T* A, unsigned lda, T* B, unsigned ldb,
+                           unsigned numThreads = 0) {
+        ThreadPool& pool = ThreadPool::shared();
+        if (numThreads == 0) numThreads = pool.size();
+        if (static_cast<size_t>(m) * n < parallelThreshold) numThreads = 1;
+        if (numThreads == 1) {
+            recurse(m, n, A, lda, B, ldb);
+            return;
+        }
+
+        // Полосы по большей стороне, кратные плитке; несколько на поток для баланса
+        bool byRows = m >= n;
+        unsigned length = byRows ? m : n;
+        unsigned strip = std::max(TILE, (length / (4 * numThreads) + TILE - 1) / TILE * TILE);
+        unsigned tasks = (length + strip - 1) / strip;
+        pool.parallelFor(tasks, numThreads, [&](unsigned t) {
+            unsigned begin = t * strip;
+            unsigned size = std::min(strip, length - begin);
+            if (byRows) {
+                recurse(size, n, A + static_cast<size_t>(begin) * lda, lda, B + begin, ldb);
+            } else {
+                recurse(m, size, A + begin, lda, B + static_cast<size_t>(begin) * ldb, ldb);
+            }
+        });
+    }
+
+    // A = A^T для квадратной n x n: диагональные плитки транспонируются на месте,
+    // внедиагональные пары (I, J) и (J, I) обмениваются с транспонированием
+    static void inPlaceSquare(unsigned n, T* A, unsigned lda, unsigned numThreads = 0) {
+        unsigned tiles = (n + TILE - 1) / TILE;
+        if (static_cast<size_t>(n) * n < parallelThreshold) numThreads = 1;
+        // Задание t - плиточная строка t вместе с плиточной строкой tiles - 1 - t,
+        // чтобы длины заданий были одинаковы (пар в строке I - tiles - I)
+        unsigned tasks = (tiles + 1) / 2;
+        ThreadPool::shared().parallelFor(tasks, numThreads, [&](unsigned t) {
+            swapTileRow(t, n, A, lda);
+            if (tiles - 1 - t != t) swapTileRow(tiles - 1 - t, n, A, lda);
+        });
+    }
+
+    // A (m x n, хранится подряд) становится A^T (n x m) на месте. Элемент с индексом
+    // k = i * n + j переходит на позицию j * m + i; каждый цикл перестановки обходится
+    // один раз, пройденные позиции отмечаются в битовой карте
+    static void inPlaceCycles(unsigned m, unsigned n, T* A) {
+        size_t size = static_cast<size_t>(m) * n;
+        if (m <= 1 || n <= 1) return;
+        size_t last = size - 1;    // Первый и последний элементы остаются на месте
+        std::vector<uint64_t> visited((size + 63) / 64, 0);
+        auto mark = [&](size_t k) { visited[k / 64] |= uint64_t(1) << (k % 64); };
+        auto seen = [&](size_t k) { return (visited[k / 64] >> (k % 64)) & 1; };
+        for (size_t start = 1; start < last; ++start) {
+            if (seen(start)) continue;
+            T carried = A[start];
+            size_t k = start;
+            do {
+                size_t next = (k % n) * m + k / n;
+                std::swap(A[next], carried);
+                mark(k);
+                k = next;
+            } while (k != start);
+        }
+    }
+
+private:
+    // Ниже этого числа элементов раздача заданий не окупается
+    static constexpr size_t parallelThreshold = size_t(1) << 16;
+
+    static void recurse(unsigned m, unsigned n, const T* A, unsigned lda, T* B, unsigned ldb) {
+        if (m <= TILE && n <= TILE) {
+            tile(m, n, A, lda, B, ldb);
+        } else if (m >= n) {
+            unsigned h = m / 2 / MICRO * MICRO;
+            if (h == 0) h = m / 2;
+            recurse(h, n, A, lda, B, ldb);
+            recurse(m - h, n, A + static_cast<size_t>(h) * lda, lda, B + h, ldb);
+        } else {
+            unsigned h = n / 2 / MICRO * MICRO;
+            if (h == 0) h = n / 2;
+            recurse(m, h, A, lda, B, ldb);
+            recurse(m, n - h, A + h, lda, B + static_cast<size_t>(h) * ldb, ldb);
+        }
+    }
+
+    // Плитка до TILE x TILE: полные микроплитки через локальный массив, края - поэлементно
+    static void tile(unsigned m, unsigned n, const T* A, unsigned lda, T* B, unsigned ldb) {
+        unsigned mFull = m / MICRO * MICRO;
+        unsigned nFull = n / MICRO * MICRO;
+        for (unsigned i = 0; i < mFull; i += MICRO) {
+            for (unsigned j = 0; j < nFull; j += MICRO) {
+                micro(A + static_cast<size_t>(i) * lda + j, lda, B + static_cast<size_t>(j) * ldb + i, ldb);
+            }
+        }
+        for (unsigned i = 0; i < m; ++i) {
+            unsigned jBegin = i < mFull ? nFull : 0;
+            for (unsigned j = jBegin; j < n; ++j) {
+                B[static_cast<size_t>(j) * ldb + i] = A[static_cast<size_t>(i) * lda + j];
+            }
+        }
+    }
+
+    static void micro(const T* A, unsigned lda, T* B, unsigned ldb) {
+        T block[MICRO][MICRO];
+        for (unsigned r = 0; r < MICRO; ++r) {
+            for (unsigned c = 0; c < MICRO; ++c) block[c][r] = A[static_cast<size_t>(r) * lda + c];
+        }
+        for (unsigned c = 0; c < MICRO; ++c) {
+            for (unsigned r = 0; r < MICRO; ++r) B[static_cast<size_t>(c) * ldb + r] = block[c][r];
+        }
+    }
+
+    // Плиточная строка I квадратной матрицы: диагональная плитка и пары (I, J), J > I
+    static void swapTileRow(unsigned I, unsigned n, T* A, unsigned lda) {
+        unsigned i0 = I * TILE;
+        unsigned h = std::min(TILE, n - i0);
+        T* diag = A + static_cast<size_t>(i0) * lda + i0;
+        for (unsigned r = 0; r < h; ++r) {
+            for (unsigned c = r + 1; c < h; ++c) {
+                std::swap(diag[static_cast<size_t>(r) * lda + c], diag[static_cast<size_t>(c) * lda + r]);
+            }
+        }
+        T buffer[TILE * TILE];
+        for (unsigned j0 = i0 + TILE; j0 < n; j0 += TILE) {
+            unsigned w = std::min(TILE, n - j0);
+            T* upper = A + static_cast<size_t>(i0) * lda + j0;    // h x w
+            T* lower = A + static_cast<size_t>(j0) * lda + i0;    // w x h
+            // buffer = upper^T, upper = lower^T, lower = buffer
+            tile(h, w, upper, lda, buffer, h);
+            tile(w, h, lower, lda, upper, lda);
+            for (unsigned r = 0; r < w; ++r) {
+                std::copy(buffer + static_cast<size_t>(r) * h, buffer + static_cast<size_t>(r + 1) * h,
+                          lower + static_cast<size_t>(r) * lda);
+            }
+        }
+    }
+};
+
+#endif
@@ -3,6 +3,10 @@
 #include "MatrixDense.h"
 #include "MatrixDiagonal.h"
 #include "MatrixBlock.h"
+#include "MatrixAlgebra.h"
+#include "MatrixSparse.h"
+#include "MatrixKronecker.h"
+#include "OutOfCore.h"
 #include <iostream>
 #include <fstream>  
 #include <random>   
@@ -43,6 +47,22 @@ int main() {
         // Произведение Кронекера
         MatrixDense<int>* K_dense = A.kroneckerProduct(B);
 
+        // Ленивое выражение: один проход без промежуточных матриц
+        MatrixDense<int> L_dense = MatrixOps::evaluate(A.expr() + B.expr() - MatrixOps::elemMult(A.expr(), B.expr()));
+
+        // Без new/delete: результат по значению, затем C = alpha * A * B + beta * C в ту же матрицу
+        MatrixDense<int> M_dense = MatrixAlgebra::multiply(A, B);
+        MatrixAlgebra::gemm(1, A, B, 1, M_dense);
+
+        // Ленивое произведение Кронекера: (A ⊗ B) * (1, ..., 1) без построения матрицы
+        MatrixKronecker<int> K_lazy(std::make_shared<MatrixDense<int>>(A), std::make_shared<MatrixDense<int>>(B));
+        std::vector<int> ones(K_lazy.cols(), 1), K_times_ones(K_lazy.rows());
+        K_lazy.multiplyVector(ones.data(), K_times_ones.data());
+
+        // Двоичный файл и матрица прямо над ним (mmap) без чтения данных
+        A.exportToBinary("MatrixDense.bin");
+        std::shared_ptr<const MatrixDense<int>> A_mapped = MatrixDense<int>::mapFile("MatrixDense.bin");
+
 
         std::ofstream outfile_dense("MatrixDense.txt");
         if (!outfile_dense) {
@@ -77,6 +97,19 @@ int main() {
         outfile_dense << "\nМатрица K_dense = KroneckerProduct(A, B):\n";
         K_dense->print(outfile_dense);
 
+        outfile_dense << "\nМатрица L_dense = A + B - A elemMult B (ленивое выражение):\n";
+        L_dense.print(outfile_dense);
+
+        outfile_dense << "\nМатрица M_dense = 2 * A * B (MatrixAlgebra::gemm):\n";
+        M_dense.print(outfile_dense);
+
+        outfile_dense << "\nВектор (A ⊗ B) * (1, ..., 1) (ленивое MatrixKronecker):\n";
+        for (int v : K_times_ones) outfile_dense << v << "\t";
+        outfile_dense << "\n";
+
+        outfile_dense << "\nМатрица A, отображенная из MatrixDense.bin:\n";
+        A_mapped->print(outfile_dense);
+
         outfile_dense.close();
 
         std::cout << "Сгенерированные матрицы и результаты операций для MatrixDense сохранены в файл MatrixDense.txt\n";
@@ -172,6 +205,10 @@ int main() {
             }
         }
 
+        // Блоки 2x2 мелкие: храним их одним куском памяти, копии и результаты
+        // операций тоже получаются упакованными
+        B1.pack();
+
 
         MatrixBlock<int> B2 = B1;
 
@@ -187,6 +224,12 @@ int main() {
         G_block += B2;
         H_block -= B2;
 
+        // То же произведение вне памяти: плитки на диске, в памяти не больше 8 плиток
+        TileStore<int> B1_tiles = TileStore<int>::fromBlock(B1, "MatrixBlock_B1");
+        TileStore<int> B2_tiles = TileStore<int>::fromBlock(B2, "MatrixBlock_B2");
+        TileStore<int> C_tiles = OutOfCoreGemm<int>::multiply(B1_tiles, B2_tiles, "MatrixBlock_C", 8 * 2 * 2 * sizeof(int));
+        MatrixBlock<int> C_out_of_core = C_tiles.toBlock();
+
         std::ofstream outfile_block("MatrixBlock.txt");
         if (!outfile_block) {
             throw std::runtime_error("Не удалось открыть файл MatrixBlock.txt для записи.");
@@ -217,6 +260,9 @@ int main() {
         outfile_block << "\nМатрица H_block = B1 - B2:\n";
         H_block.print(outfile_block);
 
+        outfile_block << "\nМатрица C_out_of_core = B1 * B2 (OutOfCoreGemm, плитки в MatrixBlock_C):\n";
+        C_out_of_core.print(outfile_block);
+
         outfile_block.close();
 
         std::cout << "Сгенерированные матрицы и результаты операций для MatrixBlock сохранены в файл MatrixBlock.txt\n";
@@ -227,6 +273,67 @@ int main() {
         delete E_block;
         delete F_block;
 
+
+        std::cout << "\n=== MatrixSparse ===\n";
+
+        // Разреженные матрицы 10x10: около 20% ненулевых элементов
+        MatrixDense<int> S1_dense(10, 10), S2_dense(10, 10);
+        for (unsigned i = 0; i < 10; ++i) {
+            for (unsigned j = 0; j < 10; ++j) {
+                if (dis(gen) > 6) S1_dense(i, j) = dis(gen);
+                if (dis(gen) > 6) S2_dense(i, j) = dis(gen);
+            }
+        }
+        MatrixSparse<int> S1 = MatrixSparse<int>::fromMatrix(S1_dense);
+        MatrixSparse<int> S2 = MatrixSparse<int>::fromMatrix(S2_dense);
+
+        // Операции
+        Matrix<int>* C_sparse = S1 * S2;
+        Matrix<int>* D_sparse = S1.elemMult(S2);
+        Matrix<int>* E_sparse = S1.transpose();
+        Matrix<int>* F_sparse = S1 + S2;
+
+        std::vector<int> x(10, 1), y(10);
+        S1.multiplyVector(x.data(), y.data());
+
+        std::ofstream outfile_sparse("MatrixSparse.txt");
+        if (!outfile_sparse) {
+            throw std::runtime_error("Не удалось открыть файл MatrixSparse.txt для записи.");
+        }
+
+        // Записываем матрицы и результаты операций в файл
+        outfile_sparse << "Матрица S1 (ненулевых: " << S1.nonZeros() << "):\n";
+        S1.print(outfile_sparse);
+
+        outfile_sparse << "\nМатрица S2 (ненулевых: " << S2.nonZeros() << "):\n";
+        S2.print(outfile_sparse);
+
+        outfile_sparse << "\nМатрица C_sparse = S1 * S2:\n";
+        C_sparse->print(outfile_sparse);
+
+        outfile_sparse << "\nМатрица D_sparse = S1 почленное умножение S2:\n";
+        D_sparse->print(outfile_sparse);
+
+        outfile_sparse << "\nМатрица E_sparse = транспонированная(S1):\n";
+        E_sparse->print(outfile_sparse);
+
+        outfile_sparse << "\nМатрица F_sparse = S1 + S2:\n";
+        F_sparse->print(outfile_sparse);
+
+        outfile_sparse << "\nВектор y = S1 * (1, ..., 1):\n";
+        for (int v : y) outfile_sparse << v << "\t";
+        outfile_sparse << "\n";
+
+        outfile_sparse.close();
+
+        std::cout << "Сгенерированные матрицы и результаты операций для MatrixSparse сохранены в файл MatrixSparse.txt\n";
+
+        // Освобождаем память
+        delete C_sparse;
+        delete D_sparse;
+        delete E_sparse;
+        delete F_sparse;
+
     } catch (const std::exception& e) {
         std::cerr << "Ошибка: " << e.what() << std::endl;
     }
@@ -0,0 +1,249 @@
+#ifndef APPROXSTATS_H
+#define APPROXSTATS_H
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ParallelSort.h"
+
+// Приближенные статистики по стратифицированной случайной выборке.
+// Массив делится на равные страты, из каждой берется одинаковое число
+// случайных элементов; стратификация гарантирует, что выборка покрывает
+// весь массив, и уменьшает дисперсию оценок для упорядоченных данных.
+// Время работы зависит от размера выборки, а не от размера массива.
+
+// Оценка с доверительным интервалом [lower, upper]
+struct Estimate {
+    double value;
+    double lower;
+    double upper;
+};
+
+struct ApproxOptions {
+    double targetRelError = 0.001;  // Допустимая относительная полуширина интервала
+    double timeBudget = 0;          // Ограничение по времени в секундах, 0 - без ограничения
+    double z = 1.96;                // Квантиль нормального распределения (1.96 - 95%)
+    size_t strata = 64;             // Число страт
+    size_t initialPerStratum = 32;  // Выборка из каждой страты на первом шаге
+    std::vector<double> quantiles = {0.25, 0.5, 0.75};
+    uint64_t seed = 42;
+};
+
+template<typename T>
+struct ApproxResult {
+    Estimate mean;
+    Estimate sum;
+    Estimate euclid;
+    Estimate manhattan;
+    T min;                                   // Минимум выборки (не меньше истинного минимума)
+    T max;                                   // Максимум выборки (не больше истинного максимума)
+    std::vector<double> quantileLevels;
+    std::vector<Estimate> quantiles;
+    size_t sampleSize;
+    double relError;                         // Достигнутая относительная полуширина интервала
+    double time;
+
+    void print(const std::string& name) const {
+        std::cout << name << " (выборка " << sampleSize << ", точность " << relError
+                  << ", время " << time << " секунд):" << std::endl;
+        printEstimate("Среднее", mean);
+        printEstimate("Сумма", sum);
+        printEstimate("Норма Евклида", euclid);
+        printEstimate("Манхэттенская норма", manhattan);
+        std::cout << "  Минимум выборки: " << min << ", максимум выборки: " << max << std::endl;
+        for (size_t q = 0; q < quantiles.size(); ++q) {
+            printEstimate("Квантиль " + std::to_string(quantileLevels[q]), quantiles[q]);
+        }
+    }
+
+private:
+    static void printEstimate(const std::string& name, const Estimate& e) {
+        std::cout << "  " << name << ": " << e.value << " [" << e.lower << ", " << e.upper << "]" << std::endl;
+    }
+};
+
+struct ApproxStats {
+
+    template<typename T>
+    static ApproxResult<T> estimate(const T* data, size_t size, int numThreads,
+                                    const ApproxOptions& options = ApproxOptions()) {
+        if (numThreads < 1) {
+            throw std::invalid_argument("Количество потоков должно быть положительным");
+        }
+        if (size == 0 || options.strata == 0 || options.initialPerStratum < 2) {
+            throw std::invalid_argument("Некорректные параметры выборки");
+        }
+        auto start = std::chrono::high_resolution_clock::now();
+
+        size_t strata = std::min(options.strata, size);
+        std::vector<Stratum<T>> strataState(strata);
+        size_t stratumSize = size / strata;
+        for (size_t h = 0; h < strata; ++h) {
+            strataState[h].begin = h * stratumSize;
+            strataState[h].end = (h == strata - 1) ? size : strataState[h].begin + stratumSize;
+        }
+
+        // Удваиваем выборку, пока не достигнута точность, время или размер массива
+        size_t perStratum = options.initialPerStratum;
+        size_t round = 0;
+        ApproxResult<T> result{};
+        for (;;) {
+            drawRound(data, strataState, perStratum, numThreads, options.seed + round * strata);
+            ++round;
+            result = summarize(strataState, size, options.z);
+
+            // Следующий шаг удваивает выборку и займет примерно столько же, сколько все предыдущие
+            double elapsed = since(start);
+            bool precise = result.relError <= options.targetRelError;
+            bool outOfTime = options.timeBudget > 0 && elapsed * 2 >= options.timeBudget;
+            bool exhausted = result.sampleSize >= size;
+            if (precise || outOfTime || exhausted) break;
+            perStratum = strataState[0].samples.size();
+        }
+
+        // Квантили - по объединенной отсортированной выборке
+        std::vector<T> pooled;
+        pooled.reserve(result.sampleSize);
+        for (auto& stratum : strataState) {
+            pooled.insert(pooled.end(), stratum.samples.begin(), stratum.samples.end());
+        }
+        ParallelSort::sort(pooled.data(), pooled.size(), numThreads);
+        double n = static_cast<double>(pooled.size());
+        for (double q : options.quantiles) {
+            if (q < 0 || q > 1) {
+                throw std::invalid_argument("Уровень квантиля должен быть в [0, 1]");
+            }
+            // Доверительный интервал по рангам: число элементов выборки ниже
+            // истинного квантиля распределено биномиально с параметрами (n, q)
+            double spread = options.z * std::sqrt(n * q * (1 - q));
+            result.quantileLevels.push_back(q);
+            result.quantiles.push_back(Estimate{
+                static_cast<double>(pooled[rankIndex(q * (n - 1), pooled.size())]),
+                static_cast<double>(pooled[rankIndex(q * (n - 1) - spread, pooled.size())]),
+                static_cast<double>(pooled[rankIndex(q * (n - 1) + spread, pooled.size())])});
+        }
+
+        result.time = since(start);
+        return result;
+    }
+
+private:
+    template<typename T>
+    struct Stratum {
+        size_t begin = 0;
+        size_t end = 0;
+        std::vector<T> samples;
+        double sum = 0;      // Сумма x
+        double sumSq = 0;    // Сумма x^2
+        double sumQuad = 0;  // Сумма x^4
+        double sumAbs = 0;   // Сумма |x|
+        T min = std::numeric_limits<T>::max();
+        T max = std::numeric_limits<T>::lowest();
+    };
+
+    static double since(std::chrono::high_resolution_clock::time_point start) {
+        using namespace std::chrono;
+        return duration_cast<duration<double>>(high_resolution_clock::now() - start).count();
+    }
+
+    static size_t rankIndex(double rank, size_t n) {
+        if (rank <= 0) return 0;
+        size_t index = static_cast<size_t>(std::llround(rank));
+        return std::min(index, n - 1);
+    }
+
+    // Добавляет count случайных элементов (с возвращением) в каждую страту
+    template<typename T>
+    static void drawRound(const T* data, std::vector<Stratum<T>>& strata, size_t count,
+                          int numThreads, uint64_t seed) {
+        size_t total = strata.size();
+        if (static_cast<size_t>(numThreads) > total) numThreads = static_cast<int>(total);
+        size_t blockSize = total / numThreads;
+
+        std::vector<std::thread> threads;
+        for (int i = 0; i < numThreads; ++i) {
+            threads.emplace_back([=, &strata]() {
+                size_t startIdx = i * blockSize;
+                size_t endIdx = (i == numThreads - 1) ? total : startIdx + blockSize;
+                for (size_t h = startIdx; h < endIdx; ++h) {
+                    Stratum<T>& s = strata[h];
+                    std::mt19937_64 gen(seed + h);
+                    std::uniform_int_distribution<size_t> pick(s.begin, s.end - 1);
+                    for (size_t k = 0; k < count; ++k) {
+                        T value = data[pick(gen)];
+                        double x = static_cast<double>(value);
+                        s.samples.push_back(value);
+                        s.sum += x;
+                        s.sumSq += x * x;
+                        s.sumQuad += x * x * x * x;
+                        s.sumAbs += std::abs(x);
+                        if (value < s.min) s.min = value;
+                        if (value > s.max) s.max = value;
+                    }
+                }
+            });
+        }
+        for (auto& th : threads) th.join();
+    }
+
+    // Стратифицированные оценки средних x, x^2 и |x| и их дисперсий:
+    // mean = sum W_h m_h, Var(mean) = sum W_h^2 s_h^2 / n_h, W_h - доля страты в массиве
+    template<typename T>
+    static ApproxResult<T> summarize(const std::vector<Stratum<T>>& strata, size_t size, double z) {
+        double mean = 0, meanSq = 0, meanAbs = 0;
+        double varMean = 0, varMeanSq = 0, varMeanAbs = 0;
+        ApproxResult<T> result{};
+        result.min = std::numeric_limits<T>::max();
+        result.max = std::numeric_limits<T>::lowest();
+        for (const auto& s : strata) {
+            double n = static_cast<double>(s.samples.size());
+            double w = static_cast<double>(s.end - s.begin) / size;
+            mean += w * s.sum / n;
+            meanSq += w * s.sumSq / n;
+            meanAbs += w * s.sumAbs / n;
+            varMean += w * w * sampleVariance(s.sum, s.sumSq, n) / n;
+            varMeanSq += w * w * sampleVariance(s.sumSq, s.sumQuad, n) / n;
+            varMeanAbs += w * w * sampleVariance(s.sumAbs, s.sumSq, n) / n;
+            result.min = std::min(result.min, s.min);
+            result.max = std::max(result.max, s.max);
+            result.sampleSize += s.samples.size();
+        }
+
+        double N = static_cast<double>(size);
+        double hwMean = z * std::sqrt(varMean);
+        double hwMeanSq = z * std::sqrt(varMeanSq);
+        double hwMeanAbs = z * std::sqrt(varMeanAbs);
+        result.mean = Estimate{mean, mean - hwMean, mean + hwMean};
+        result.sum = Estimate{N * mean, N * (mean - hwMean), N * (mean + hwMean)};
+        result.euclid = Estimate{std::sqrt(N * meanSq), std::sqrt(N * std::max(0.0, meanSq - hwMeanSq)),
+                                 std::sqrt(N * (meanSq + hwMeanSq))};
+        result.manhattan = Estimate{N * meanAbs, N * (meanAbs - hwMeanAbs), N * (meanAbs + hwMeanAbs)};
+
+        // Ошибку среднего меряем относительно среднего модуля: само среднее может быть близко к нулю
+        double relError = 0;
+        if (meanAbs > 0) {
+            relError = std::max(hwMean / meanAbs, hwMeanAbs / meanAbs);
+        }
+        if (meanSq > 0) {
+            relError = std::max(relError, hwMeanSq / meanSq);
+        }
+        result.relError = relError;
+        return result;
+    }
+
+    static double sampleVariance(double sum, double sumSq, double n) {
+        if (n < 2) return 0;
+        return std::max(0.0, (sumSq - sum * sum / n) / (n - 1));
+    }
+};
+
+#endif
@@ -0,0 +1,293 @@
+#ifndef COMPRESSEDVECTOR_H
+#define COMPRESSEDVECTOR_H
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Сжатый целочисленный вектор: блоки по 128 элементов, в каждом значения
+// хранятся как смещения от минимума блока (frame of reference), упакованные
+// в минимально необходимое число бит. 128 значений по W бит занимают ровно
+// 2*W слов по 64 бита. Для каждого блока хранятся min/max/sum, поэтому
+// min, max и sum вычисляются по метаданным без распаковки, а остальные
+// редукции распаковывают блоки в небольшой буфер на стеке, не трогая
+// исходный несжатый массив.
+template <typename T = int>
+class CompressedVector {
+    static_assert(std::is_integral_v<T> && sizeof(T) <= 4, "Поддерживаются целые типы до 32 бит");
+
+public:
+    static constexpr size_t blockSize = 128;
+
+    struct BlockInfo {
+        T min;
+        T max;
+        int64_t sum;
+        uint32_t bits;    // Ширина упакованного смещения
+        size_t offset;    // Начало блока в packed (в словах)
+    };
+
+    size_t size = 0;
+    std::vector<BlockInfo> blocks;
+    std::vector<uint64_t> packed;
+
+    // Сжатие массива: потоки считают метаданные своих блоков, затем по
+    // префиксным суммам размеров упаковывают блоки сразу на свои места
+    static CompressedVector<T> fromArray(const T* data, size_t size, int numThreads = 1) {
+        CompressedVector<T> result;
+        result.size = size;
+        size_t numBlocks = (size + blockSize - 1) / blockSize;
+        result.blocks.resize(numBlocks);
+        BlockInfo* info = result.blocks.data();
+
+        forBlocks(numBlocks, numThreads, [=](size_t startIdx, size_t endIdx) {
+            for (size_t b = startIdx; b < endIdx; ++b) {
+                const T* block = data + b * blockSize;
+                size_t count = std::min(blockSize, size - b * blockSize);
+                T minVal = *std::min_element(block, block + count);
+                T maxVal = *std::max_element(block, block + count);
+                int64_t sum = 0;
+                for (size_t k = 0; k < count; ++k) sum += block[k];
+                uint32_t range = static_cast<uint32_t>(static_cast<int64_t>(maxVal) - minVal);
+                info[b] = BlockInfo{minVal, maxVal, sum, static_cast<uint32_t>(std::bit_width(range)), 0};
+            }
+        });
+
+        size_t offset = 0;
+        for (auto& block : result.blocks) {
+            block.offset = offset;
+            offset += wordsPerBlock(block.bits);
+        }
+        // Лишнее слово в конце: распаковка всегда читает слово после текущего
+        result.packed.assign(offset + 1, 0);
+        uint64_t* out = result.packed.data();
+
+        forBlocks(numBlocks, numThreads, [=](size_t startIdx, size_t endIdx) {
+            for (size_t b = startIdx; b < endIdx; ++b) {
+                const T* block = data + b * blockSize;
+                size_t count = std::min(blockSize, size - b * blockSize);
+                uint32_t bits = info[b].bits;
+                if (bits == 0) continue;
+                uint64_t* words = out + info[b].offset;
+                for (size_t k = 0; k < count; ++k) {
+                    uint64_t delta = static_cast<uint32_t>(static_cast<int64_t>(block[k]) - info[b].min);
+                    size_t bitPos = k * bits;
+                    size_t word = bitPos / 64;
+                    unsigned shift = bitPos % 64;
+                    words[word] |= delta << shift;
+                    if (shift + bits > 64) words[word + 1] |= delta >> (64 - shift);
+                }
+            }
+        });
+        return result;
+    }
+
+    // Распаковка всего вектора в заранее выделенный массив
+    void toArray(T* out, size_t outSize, int numThreads = 1) const {
+        if (outSize != size) {
+            throw std::invalid_argument("Размеры векторов не совпадают");
+        }
+        forBlocks(blocks.size(), numThreads, [this, out](size_t startIdx, size_t endIdx) {
+            uint32_t deltas[blockSize];
+            for (size_t b = startIdx; b < endIdx; ++b) {
+                unpack(b, deltas);
+                size_t count = blockCount(b);
+                for (size_t k = 0; k < count; ++k) {
+                    out[b * blockSize + k] = static_cast<T>(blocks[b].min + static_cast<int64_t>(deltas[k]));
+                }
+            }
+        });
+    }
+
+    T get(size_t i) const {
+        if (i >= size) {
+            throw std::out_of_range("Индекс за пределами вектора");
+        }
+        const BlockInfo& block = blocks[i / blockSize];
+        uint32_t bits = block.bits;
+        if (bits == 0) return block.min;
+        size_t bitPos = (i % blockSize) * bits;
+        const uint64_t* words = packed.data() + block.offset;
+        uint64_t value = words[bitPos / 64] >> (bitPos % 64);
+        if (bitPos % 64 + bits > 64) value |= words[bitPos / 64 + 1] << (64 - bitPos % 64);
+        return static_cast<T>(block.min + static_cast<int64_t>(value & mask(bits)));
+    }
+
+    // Размер сжатого представления в байтах
+    size_t bytes() const {
+        return packed.size() * sizeof(uint64_t) + blocks.size() * sizeof(BlockInfo);
+    }
+
+    // Редукции по метаданным: O(число блоков)
+
+    T findMin(int numThreads = 1) const {
+        return reduceBlocks<T>(numThreads, std::numeric_limits<T>::max(),
+            [this](size_t b) { return blocks[b].min; },
+            [](T a, T b) { return std::min(a, b); });
+    }
+
+    T findMax(int numThreads = 1) const {
+        return reduceBlocks<T>(numThreads, std::numeric_limits<T>::lowest(),
+            [this](size_t b) { return blocks[b].max; },
+            [](T a, T b) { return std::max(a, b); });
+    }
+
+    int64_t findSum(int numThreads = 1) const {
+        return reduceBlocks<int64_t>(numThreads, 0,
+            [this](size_t b) { return blocks[b].sum; },
+            [](int64_t a, int64_t b) { return a + b; });
+    }
+
+    // Сумма на отрезке [begin, end): целые блоки - по метаданным, края - распаковкой
+    int64_t findSum(size_t begin, size_t end) const {
+        if (begin > end || end > size) {
+            throw std::out_of_range("Некорректный диапазон");
+        }
+        int64_t sum = 0;
+        size_t i = begin;
+        while (i < end) {
+            size_t b = i / blockSize;
+            size_t blockBegin = b * blockSize;
+            size_t blockEnd = std::min(blockBegin + blockSize, end);
+            if (i == blockBegin && blockEnd == blockBegin + blockCount(b)) {
+                sum += blocks[b].sum;
+            } else {
+                uint32_t deltas[blockSize];
+                unpack(b, deltas);
+                for (size_t k = i - blockBegin; k < blockEnd - blockBegin; ++k) {
+                    sum += blocks[b].min + static_cast<int64_t>(deltas[k]);
+                }
+            }
+            i = blockEnd;
+        }
+        return sum;
+    }
+
+    // Редукции с распаковкой блоков
+
+    int64_t findManhattan(int numThreads = 1) const {
+        return reduceBlocks<int64_t>(numThreads, 0, [this](size_t b) {
+            // Блок целиком неотрицательный или неположительный - модуль выносится за сумму
+            if (blocks[b].min >= 0 || blocks[b].max <= 0) {
+                return std::abs(blocks[b].sum);
+            }
+            uint32_t deltas[blockSize];
+            unpack(b, deltas);
+            int64_t minVal = blocks[b].min;
+            int64_t sumAbs = 0;
+            size_t count = blockCount(b);
+            for (size_t k = 0; k < count; ++k) sumAbs += std::abs(minVal + static_cast<int64_t>(deltas[k]));
+            return sumAbs;
+        }, [](int64_t a, int64_t b) { return a + b; });
+    }
+
+    double findEuclid(int numThreads = 1) const {
+        double sumSq = reduceBlocks<double>(numThreads, 0.0, [this](size_t b) {
+            uint32_t deltas[blockSize];
+            unpack(b, deltas);
+            double minVal = static_cast<double>(blocks[b].min);
+            double localSumSq = 0;
+            size_t count = blockCount(b);
+            for (size_t k = 0; k < count; ++k) {
+                double x = minVal + deltas[k];
+                localSumSq += x * x;
+            }
+            return localSumSq;
+        }, [](double a, double b) { return a + b; });
+        return std::sqrt(sumSq);
+    }
+
+private:
+    using Unpacker = void (*)(const uint64_t*, uint32_t*);
+
+    static constexpr size_t wordsPerBlock(uint32_t bits) { return blockSize * bits / 64; }
+
+    static constexpr uint64_t mask(uint32_t bits) {
+        return bits >= 64 ? ~uint64_t(0) : (uint64_t(1) << bits) - 1;
+    }
+
+    size_t blockCount(size_t b) const { return std::min(blockSize, size - b * blockSize); }
+
+    // Распаковка блока с шириной W, известной при компиляции. Каждое значение
+    // собирается из двух соседних слов сдвигом без ветвления: (hi << 1) << (63 - shift)
+    // равно hi << (64 - shift) и обнуляется при shift = 0, поэтому второе слово
+    // читается всегда (для последнего блока это лишнее слово в конце packed).
+    // С -O3 и сборкой слов (-mavx2, -march=native) цикл векторизуется
+    template<uint32_t W>
+    static void unpackBits(const uint64_t* words, uint32_t* out) {
+        if constexpr (W == 0) {
+            std::fill(out, out + blockSize, 0u);
+        } else {
+            for (size_t k = 0; k < blockSize; ++k) {
+                size_t bitPos = k * W;
+                size_t word = bitPos / 64;
+                unsigned shift = bitPos % 64;
+                uint64_t value = (words[word] >> shift) | ((words[word + 1] << 1) << (63 - shift));
+                out[k] = static_cast<uint32_t>(value & mask(W));
+            }
+        }
+    }
+
+    template<size_t... W>
+    static constexpr std::array<Unpacker, sizeof...(W)> makeUnpackers(std::index_sequence<W...>) {
+        return {&unpackBits<static_cast<uint32_t>(W)>...};
+    }
+
+    void unpack(size_t b, uint32_t* out) const {
+        static constexpr auto unpackers = makeUnpackers(std::make_index_sequence<33>{});
+        unpackers[blocks[b].bits](packed.data() + blocks[b].offset, out);
+    }
+
+    template<typename Func>
+    static void forBlocks(size_t count, int numThreads, Func func) {
+        if (numThreads < 1) {
+            throw std::invalid_argument("Количество потоков должно быть положительным");
+        }
+        if (static_cast<size_t>(numThreads) > count) numThreads = count > 0 ? static_cast<int>(count) : 1;
+        size_t blockCount = count / numThreads;
+
+        std::vector<std::thread> threads;
+        for (int i = 0; i < numThreads; ++i) {
+            threads.emplace_back([=, &func]() {
+                size_t startIdx = i * blockCount;
+                size_t endIdx = (i == numThreads - 1) ? count : startIdx + blockCount;
+                func(startIdx, endIdx);
+            });
+        }
+        for (auto& th : threads) th.join();
+    }
+
+    template<typename R, typename Map, typename Combine>
+    R reduceBlocks(int numThreads, R init, Map map, Combine combine) const {
+        if (numThreads < 1) {
+            throw std::invalid_argument("Количество потоков должно быть положительным");
+        }
+        size_t count = blocks.size();
+        int threadsUsed = static_cast<size_t>(numThreads) > count ? std::max<int>(static_cast<int>(count), 1) : numThreads;
+        std::vector<R> partial(threadsUsed, init);
+        size_t blockCount = count / threadsUsed;
+        std::vector<std::thread> threads;
+        for (int i = 0; i < threadsUsed; ++i) {
+            threads.emplace_back([=, &partial, &map, &combine]() {
+                size_t startIdx = i * blockCount;
+                size_t endIdx = (i == threadsUsed - 1) ? count : startIdx + blockCount;
+                R local = init;
+                for (size_t b = startIdx; b < endIdx; ++b) local = combine(local, map(b));
+                partial[i] = local;
+            });
+        }
+        for (auto& th : threads) th.join();
+        return std::accumulate(partial.begin(), partial.end(), init, combine);
+    }
+};
+
+#endif
@@ -12,6 +12,23 @@
 #include <cmath>
 #include <algorithm>
 
+#include "SparseVector.h"
+#include "Trace.h"
+#include "Pipeline.h"
+#include "ParallelSort.h"
+#include "VectorOps.h"
+#include "ApproxStats.h"
+#include "CompressedVector.h"
+#include "StreamingVector.h"
+#include "Roofline.h"
+
+// Сравнение с std::sort(std::execution::par) включается макросом LAB3_PAR_SORT:
+// libstdc++ реализует параллельные алгоритмы через TBB, и сборка требует -ltbb,
+// например g++ -std=c++20 -pthread -DLAB3_PAR_SORT Lab3.cpp -ltbb
+#if defined(LAB3_PAR_SORT)
+#include <execution>
+#endif
+
 using namespace std::chrono;
 
 struct ArrayHelper {
@@ -27,7 +44,7 @@ struct ArrayHelper {
 
     template<typename T>
     static T findMax(T* data, size_t size) {
-        T maxVal = std::numeric_limits<T>::min();
+        T maxVal = std::numeric_limits<T>::lowest();
         for (size_t i = 0; i < size; ++i) {
             if (data[i] > maxVal) maxVal = data[i];
         }
@@ -68,10 +85,14 @@ struct ArrayHelper {
         std::vector<T> localMins(numThreads, std::numeric_limits<T>::max());
         size_t blockSize = size / numThreads;
 
+        uint64_t spawnBegin = Tracer::now();
         for (int i = 0; i < numThreads; ++i) {
+            uint64_t spawnTs = Tracer::now();
             threads.emplace_back([=, &localMins]() {
+                Tracer::record("thread_start", "findMinParallel", spawnTs, Tracer::now());
                 size_t startIdx = i * blockSize;
                 size_t endIdx = (i == numThreads - 1) ? size : startIdx + blockSize;
+                TraceScope chunkScope("chunk", "findMinParallel", startIdx, endIdx);
                 T localMin = std::numeric_limits<T>::max();
                 for (size_t j = startIdx; j < endIdx; ++j) {
                     if (data[j] < localMin) localMin = data[j];
@@ -79,28 +100,40 @@ struct ArrayHelper {
                 localMins[i] = localMin;
             });
         }
-        for (auto& th : threads) th.join();
+        Tracer::record("spawn", "findMinParallel", spawnBegin, Tracer::now());
+        {
+            TraceScope joinScope("join", "findMinParallel");
+            for (auto& th : threads) th.join();
+        }
         return *std::min_element(localMins.begin(), localMins.end());
     }
 
     template<typename T>
     static T findMaxParallel(T* data, size_t size, int numThreads) {
         std::vector<std::thread> threads;
-        std::vector<T> localMaxs(numThreads, std::numeric_limits<T>::min());
+        std::vector<T> localMaxs(numThreads, std::numeric_limits<T>::lowest());
         size_t blockSize = size / numThreads;
 
+        uint64_t spawnBegin = Tracer::now();
         for (int i = 0; i < numThreads; ++i) {
+            uint64_t spawnTs = Tracer::now();
             threads.emplace_back([=, &localMaxs]() {
+                Tracer::record("thread_start", "findMaxParallel", spawnTs, Tracer::now());
                 size_t startIdx = i * blockSize;
                 size_t endIdx = (i == numThreads - 1) ? size : startIdx + blockSize;
-                T localMax = std::numeric_limits<T>::min();
+                TraceScope chunkScope("chunk", "findMaxParallel", startIdx, endIdx);
+                T localMax = std::numeric_limits<T>::lowest();
                 for (size_t j = startIdx; j < endIdx; ++j) {
                     if (data[j] > localMax) localMax = data[j];
                 }
                 localMaxs[i] = localMax;
             });
         }
-        for (auto& th : threads) th.join();
+        Tracer::record("spawn", "findMaxParallel", spawnBegin, Tracer::now());
+        {
+            TraceScope joinScope("join", "findMaxParallel");
+            for (auto& th : threads) th.join();
+        }
         return *std::max_element(localMaxs.begin(), localMaxs.end());
     }
 
@@ -110,10 +143,14 @@ struct ArrayHelper {
         std::vector<T> localSums(numThreads, 0);
         size_t blockSize = size / numThreads;
 
+        uint64_t spawnBegin = Tracer::now();
         for (int i = 0; i < numThreads; ++i) {
+            uint64_t spawnTs = Tracer::now();
             threads.emplace_back([=, &localSums]() {
+                Tracer::record("thread_start", "findSumParallel", spawnTs, Tracer::now());
                 size_t startIdx = i * blockSize;
                 size_t endIdx = (i == numThreads - 1) ? size : startIdx + blockSize;
+                TraceScope chunkScope("chunk", "findSumParallel", startIdx, endIdx);
                 T localSum = 0;
                 for (size_t j = startIdx; j < endIdx; ++j) {
                     localSum += data[j];
@@ -121,7 +158,11 @@ struct ArrayHelper {
                 localSums[i] = localSum;
             });
         }
-        for (auto& th : threads) th.join();
+        Tracer::record("spawn", "findSumParallel", spawnBegin, Tracer::now());
+        {
+            TraceScope joinScope("join", "findSumParallel");
+            for (auto& th : threads) th.join();
+        }
         return std::accumulate(localSums.begin(), localSums.end(), static_cast<T>(0));
     }
 
@@ -131,10 +172,14 @@ struct ArrayHelper {
         std::vector<T> localSums(numThreads, 0);
         size_t blockSize = size / numThreads;
 
+        uint64_t spawnBegin = Tracer::now();
         for (int i = 0; i < numThreads; ++i) {
+            uint64_t spawnTs = Tracer::now();
             threads.emplace_back([=, &localSums]() {
+                Tracer::record("thread_start", "findEuclidParallel", spawnTs, Tracer::now());
                 size_t startIdx = i * blockSize;
                 size_t endIdx = (i == numThreads - 1) ? size : startIdx + blockSize;
+                TraceScope chunkScope("chunk", "findEuclidParallel", startIdx, endIdx);
                 T localSumSq = 0;
                 for (size_t j = startIdx; j < endIdx; ++j) {
                     localSumSq += data[j] * data[j];
@@ -142,7 +187,11 @@ struct ArrayHelper {
                 localSums[i] = localSumSq;
             });
         }
-        for (auto& th : threads) th.join();
+        Tracer::record("spawn", "findEuclidParallel", spawnBegin, Tracer::now());
+        {
+            TraceScope joinScope("join", "findEuclidParallel");
+            for (auto& th : threads) th.join();
+        }
         T totalSumSq = std::accumulate(localSums.begin(), localSums.end(), static_cast<T>(0));
         return std::sqrt(totalSumSq);
     }
@@ -153,10 +202,14 @@ struct ArrayHelper {
         std::vector<T> localSums(numThreads, 0);
         size_t blockSize = size / numThreads;
 
+        uint64_t spawnBegin = Tracer::now();
         for (int i = 0; i < numThreads; ++i) {
+            uint64_t spawnTs = Tracer::now();
             threads.emplace_back([=, &localSums]() {
+                Tracer::record("thread_start", "findManhattanParallel", spawnTs, Tracer::now());
                 size_t startIdx = i * blockSize;
                 size_t endIdx = (i == numThreads - 1) ? size : startIdx + blockSize;
+                TraceScope chunkScope("chunk", "findManhattanParallel", startIdx, endIdx);
                 T localSumAbs = 0;
                 for (size_t j = startIdx; j < endIdx; ++j) {
                     localSumAbs += std::abs(data[j]);
@@ -164,7 +217,11 @@ struct ArrayHelper {
                 localSums[i] = localSumAbs;
             });
         }
-        for (auto& th : threads) th.join();
+        Tracer::record("spawn", "findManhattanParallel", spawnBegin, Tracer::now());
+        {
+            TraceScope joinScope("join", "findManhattanParallel");
+            for (auto& th : threads) th.join();
+        }
         return std::accumulate(localSums.begin(), localSums.end(), static_cast<T>(0));
     }
 
@@ -174,10 +231,14 @@ struct ArrayHelper {
         std::vector<T> localSums(numThreads, 0);
         size_t blockSize = size / numThreads;
 
+        uint64_t spawnBegin = Tracer::now();
         for (int i = 0; i < numThreads; ++i) {
+            uint64_t spawnTs = Tracer::now();
             threads.emplace_back([=, &localSums]() {
+                Tracer::record("thread_start", "findScalarParallel", spawnTs, Tracer::now());
                 size_t startIdx = i * blockSize;
                 size_t endIdx = (i == numThreads - 1) ? size : startIdx + blockSize;
+                TraceScope chunkScope("chunk", "findScalarParallel", startIdx, endIdx);
                 T localSum = 0;
                 for (size_t j = startIdx; j < endIdx; ++j) {
                     localSum += data1[j] * data2[j];
@@ -185,9 +246,24 @@ struct ArrayHelper {
                 localSums[i] = localSum;
             });
         }
-        for (auto& th : threads) th.join();
+        Tracer::record("spawn", "findScalarParallel", spawnBegin, Tracer::now());
+        {
+            TraceScope joinScope("join", "findScalarParallel");
+            for (auto& th : threads) th.join();
+        }
         return std::accumulate(localSums.begin(), localSums.end(), static_cast<T>(0));
     }
+
+    // Сортировка: radix sort для чисел, слиянием для остальных типов
+    template<typename T>
+    static void sortParallel(T* data, size_t size, int numThreads) {
+        ParallelSort::sort(data, size, numThreads);
+    }
+
+    template<typename T>
+    static void sortParallel(const T* src, T* dst, size_t size, int numThreads) {
+        ParallelSort::sort(src, dst, size, numThreads);
+    }
 };
 
 
@@ -242,6 +318,52 @@ public:
             throw std::runtime_error("Не удалось открыть файл для чтения");
         }
     }
+
+    // Поэлементные операции, каждая - один параллельный проход по памяти
+
+    // Лист ленивого выражения над данными вектора
+    VecRef<T> expr() const {
+        return VecRef<T>{data, size};
+    }
+
+    // Вычисление выражения в этот вектор за один проход
+    template<VecExpression E>
+    void assign(const E& e, int numThreads) {
+        if (VectorOps::length(e) != size) {
+            throw std::invalid_argument("Размеры векторов не совпадают");
+        }
+        VectorOps::assign(data, e, numThreads);
+    }
+
+    // this = a * x + this
+    void axpy(T a, const VectorData<T>& x, int numThreads) {
+        if (x.size != size) {
+            throw std::invalid_argument("Размеры векторов не совпадают");
+        }
+        VectorOps::axpy(a, x.data, data, size, numThreads);
+    }
+
+    void scale(T a, int numThreads) {
+        VectorOps::scale(a, data, size, numThreads);
+    }
+
+    void add(const VectorData<T>& x, int numThreads) {
+        if (x.size != size) {
+            throw std::invalid_argument("Размеры векторов не совпадают");
+        }
+        VectorOps::add(data, x.data, data, size, numThreads);
+    }
+
+    void multiply(const VectorData<T>& x, int numThreads) {
+        if (x.size != size) {
+            throw std::invalid_argument("Размеры векторов не совпадают");
+        }
+        VectorOps::multiply(data, x.data, data, size, numThreads);
+    }
+
+    void clamp(T lo, T hi, int numThreads) {
+        VectorOps::clamp(data, size, lo, hi, numThreads);
+    }
 };
 
 template<typename T>
@@ -375,12 +497,343 @@ public:
         double elapsed = duration_cast<duration<double>>(end - start).count();
         return FuncResult<T>(result, elapsed);
     }
+
+    // сжатые целочисленные векторы
+
+    template<typename T>
+    static CompressedVector<T> toCompressed(VectorData<T>& vec, int numThreads) {
+        return CompressedVector<T>::fromArray(vec.data, vec.size, numThreads);
+    }
+
+    template<typename T>
+    static FuncResult<T> findMinCompressed(CompressedVector<T>& vec, int numThreads) {
+        auto start = high_resolution_clock::now();
+        T result = vec.findMin(numThreads);
+        auto end = high_resolution_clock::now();
+        double elapsed = duration_cast<duration<double>>(end - start).count();
+        return FuncResult<T>(result, elapsed);
+    }
+
+    template<typename T>
+    static FuncResult<T> findMaxCompressed(CompressedVector<T>& vec, int numThreads) {
+        auto start = high_resolution_clock::now();
+        T result = vec.findMax(numThreads);
+        auto end = high_resolution_clock::now();
+        double elapsed = duration_cast<duration<double>>(end - start).count();
+        return FuncResult<T>(result, elapsed);
+    }
+
+    template<typename T>
+    static FuncResult<int64_t> findSumCompressed(CompressedVector<T>& vec, int numThreads) {
+        auto start = high_resolution_clock::now();
+        int64_t result = vec.findSum(numThreads);
+        auto end = high_resolution_clock::now();
+        double elapsed = duration_cast<duration<double>>(end - start).count();
+        return FuncResult<int64_t>(result, elapsed);
+    }
+
+    template<typename T>
+    static FuncResult<int64_t> findManhattanCompressed(CompressedVector<T>& vec, int numThreads) {
+        auto start = high_resolution_clock::now();
+        int64_t result = vec.findManhattan(numThreads);
+        auto end = high_resolution_clock::now();
+        double elapsed = duration_cast<duration<double>>(end - start).count();
+        return FuncResult<int64_t>(result, elapsed);
+    }
+
+    template<typename T>
+    static FuncResult<double> findEuclidCompressed(CompressedVector<T>& vec, int numThreads) {
+        auto start = high_resolution_clock::now();
+        double result = vec.findEuclid(numThreads);
+        auto end = high_resolution_clock::now();
+        double elapsed = duration_cast<duration<double>>(end - start).count();
+        return FuncResult<double>(result, elapsed);
+    }
+
+    // Приближенные статистики по выборке с доверительными интервалами
+    template<typename T>
+    static ApproxResult<T> findStatsApprox(VectorData<T>& vec, int numThreads,
+                                           const ApproxOptions& options = ApproxOptions()) {
+        return ApproxStats::estimate(vec.data, vec.size, numThreads, options);
+    }
+
+    // Сумма элементов ленивого выражения за один проход, например sum((a*x+y)^2)
+    template<VecExpression E>
+    static FuncResult<typename E::value_type> findSumFused(const E& expr, int numThreads) {
+        using T = typename E::value_type;
+        auto start = high_resolution_clock::now();
+        T result = VectorOps::sum(expr, numThreads);
+        auto end = high_resolution_clock::now();
+        double elapsed = duration_cast<duration<double>>(end - start).count();
+        return FuncResult<T>(result, elapsed);
+    }
+
+    // сортировка, результат - медиана отсортированного массива
+
+    template<typename T>
+    static FuncResult<T> sortParallel(VectorData<T>& vec, int numThreads) {
+        auto start = high_resolution_clock::now();
+        ArrayHelper::sortParallel(vec.data, vec.size, numThreads);
+        auto end = high_resolution_clock::now();
+        double elapsed = duration_cast<duration<double>>(end - start).count();
+        return FuncResult<T>(vec.data[vec.size / 2], elapsed);
+    }
+
+    template<typename T>
+    static FuncResult<T> sortParallel(VectorData<T>& src, VectorData<T>& dst, int numThreads) {
+        if (src.size != dst.size) {
+            throw std::invalid_argument("Размеры векторов не совпадают");
+        }
+        auto start = high_resolution_clock::now();
+        ArrayHelper::sortParallel(src.data, dst.data, src.size, numThreads);
+        auto end = high_resolution_clock::now();
+        double elapsed = duration_cast<duration<double>>(end - start).count();
+        return FuncResult<T>(dst.data[dst.size / 2], elapsed);
+    }
+
+    // разреженные методы
+
+    template<typename T>
+    static SparseVector<T> toSparse(VectorData<T>& vec, int numThreads) {
+        return SparseVector<T>::fromDense(vec.data, vec.size, numThreads);
+    }
+
+    template<typename T>
+    static FuncResult<T> findScalarSparse(SparseVector<T>& sparse, VectorData<T>& vec, int numThreads) {
+        auto start = high_resolution_clock::now();
+        T result = sparse.dotDense(vec.data, vec.size, numThreads);
+        auto end = high_resolution_clock::now();
+        double elapsed = duration_cast<duration<double>>(end - start).count();
+        return FuncResult<T>(result, elapsed);
+    }
+
+    template<typename T>
+    static FuncResult<T> findScalarSparse(SparseVector<T>& vec1, SparseVector<T>& vec2, int numThreads) {
+        auto start = high_resolution_clock::now();
+        T result = vec1.dot(vec2, numThreads);
+        auto end = high_resolution_clock::now();
+        double elapsed = duration_cast<duration<double>>(end - start).count();
+        return FuncResult<T>(result, elapsed);
+    }
+};
+
+// Конвейер: генерация -> запись в файл -> чтение из файла -> редукции.
+// Пока чанк N+1 генерируется, чанк N записывается, а чанк N-1 уже редуцируется.
+template<typename T>
+struct PipelineResult {
+    T min;
+    T max;
+    T sum;
+    double avg;
+    double euclid;
+    T manhattan;
+    double time;               // Общее время конвейера
+    double stageTimes[4] = {}; // Время работы каждой стадии без учета ожидания
+};
+
+class VectorPipeline {
+public:
+    static constexpr int numStages = 4;
+
+    template<typename T>
+    static PipelineResult<T> run(size_t size, size_t chunkSize, T minVal, T maxVal,
+                                 const std::string& filename, size_t channelCapacity = 2) {
+        if (minVal >= maxVal) {
+            throw std::invalid_argument("minVal должно быть меньше maxVal");
+        }
+        if (chunkSize == 0) {
+            throw std::invalid_argument("Размер чанка должен быть положительным");
+        }
+
+        PipelineResult<T> result{};
+        Totals<T> totals;
+        auto start = high_resolution_clock::now();
+        {
+            Pipeline pipeline(numStages);
+            Channel<std::vector<T>> generated(pipeline.getScheduler(), channelCapacity);
+            Channel<ChunkRef> written(pipeline.getScheduler(), channelCapacity);
+            Channel<std::vector<T>> loaded(pipeline.getScheduler(), channelCapacity);
+
+            pipeline.addStage(generateStage(generated, size, chunkSize, minVal, maxVal, result.stageTimes[0]));
+            pipeline.addStage(writeStage(generated, written, filename, result.stageTimes[1]));
+            pipeline.addStage(readStage<T>(written, loaded, filename, result.stageTimes[2]));
+            pipeline.addStage(reduceStage(loaded, totals, result.stageTimes[3]));
+            pipeline.run();
+        }
+        auto end = high_resolution_clock::now();
+
+        if (totals.count != size) {
+            throw std::runtime_error("Ошибка чтения данных из файла");
+        }
+        result.min = totals.min;
+        result.max = totals.max;
+        result.sum = totals.sum;
+        result.avg = totals.sum / static_cast<double>(totals.count);
+        result.euclid = std::sqrt(totals.sumSq);
+        result.manhattan = totals.sumAbs;
+        result.time = duration_cast<duration<double>>(end - start).count();
+        return result;
+    }
+
+private:
+    // Положение записанного чанка в файле (в элементах)
+    struct ChunkRef {
+        size_t offset;
+        size_t count;
+    };
+
+    template<typename T>
+    struct Totals {
+        T min = std::numeric_limits<T>::max();
+        T max = std::numeric_limits<T>::lowest();
+        T sum = 0;
+        T sumSq = 0;
+        T sumAbs = 0;
+        size_t count = 0;
+    };
+
+    static double since(high_resolution_clock::time_point start) {
+        return duration_cast<duration<double>>(high_resolution_clock::now() - start).count();
+    }
+
+    template<typename T>
+    static Task generateStage(Channel<std::vector<T>>& out, size_t size, size_t chunkSize,
+                              T minVal, T maxVal, double& busy) {
+        ChannelGuard guard(out);
+        for (size_t offset = 0; offset < size; offset += chunkSize) {
+            auto start = high_resolution_clock::now();
+            std::vector<T> chunk(std::min(chunkSize, size - offset));
+            for (auto& value : chunk) {
+                value = static_cast<T>(rand()) / RAND_MAX * (maxVal - minVal) + minVal;
+            }
+            busy += since(start);
+            if (!co_await out.send(std::move(chunk))) co_return;
+        }
+    }
+
+    template<typename T>
+    static Task writeStage(Channel<std::vector<T>>& in, Channel<ChunkRef>& out,
+                           std::string filename, double& busy) {
+        ChannelGuard guard(in, out);
+        std::ofstream outFile(filename, std::ios::binary);
+        if (!outFile) {
+            throw std::runtime_error("Не удалось открыть файл для записи");
+        }
+        size_t offset = 0;
+        while (auto chunk = co_await in.receive()) {
+            auto start = high_resolution_clock::now();
+            outFile.write(reinterpret_cast<const char*>(chunk->data()), sizeof(T) * chunk->size());
+            // Чтение идет параллельно, поэтому данные должны дойти до файла до уведомления
+            outFile.flush();
+            if (!outFile) {
+                throw std::runtime_error("Ошибка записи данных в файл");
+            }
+            busy += since(start);
+            if (!co_await out.send(ChunkRef{offset, chunk->size()})) co_return;
+            offset += chunk->size();
+        }
+    }
+
+    template<typename T>
+    static Task readStage(Channel<ChunkRef>& in, Channel<std::vector<T>>& out,
+                          std::string filename, double& busy) {
+        ChannelGuard guard(in, out);
+        std::ifstream inFile;
+        while (auto ref = co_await in.receive()) {
+            auto start = high_resolution_clock::now();
+            // Файл открываем после первой записи, когда он уже создан
+            if (!inFile.is_open()) {
+                inFile.open(filename, std::ios::binary);
+                if (!inFile) {
+                    throw std::runtime_error("Не удалось открыть файл для чтения");
+                }
+            }
+            std::vector<T> chunk(ref->count);
+            inFile.seekg(static_cast<std::streamoff>(ref->offset * sizeof(T)));
+            inFile.read(reinterpret_cast<char*>(chunk.data()), sizeof(T) * ref->count);
+            if (static_cast<size_t>(inFile.gcount()) != sizeof(T) * ref->count) {
+                throw std::runtime_error("Ошибка чтения данных из файла");
+            }
+            busy += since(start);
+            if (!co_await out.send(std::move(chunk))) co_return;
+        }
+    }
+
+    template<typename T>
+    static Task reduceStage(Channel<std::vector<T>>& in, Totals<T>& totals, double& busy) {
+        ChannelGuard guard(in);
+        while (auto chunk = co_await in.receive()) {
+            auto start = high_resolution_clock::now();
+            T* data = chunk->data();
+            size_t size = chunk->size();
+            totals.min = std::min(totals.min, ArrayHelper::findMin(data, size));
+            totals.max = std::max(totals.max, ArrayHelper::findMax(data, size));
+            totals.sum += ArrayHelper::findSum(data, size);
+            T sumSq = 0;
+            for (size_t i = 0; i < size; ++i) sumSq += data[i] * data[i];
+            totals.sumSq += sumSq;
+            totals.sumAbs += ArrayHelper::findManhattan(data, size);
+            totals.count += size;
+            busy += since(start);
+        }
+    }
 };
 
-int main() {
+// Режим roofline: Lab3 --roofline [размер массива].
+// Измеряет пики памяти и вычислений, затем долю пиков для каждой операции ArrayHelper.
+void runRoofline(size_t arraySize) {
+    int maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<int> threadCounts;
+    for (int t = 1; t < maxThreads; t *= 2) threadCounts.push_back(t);
+    threadCounts.push_back(maxThreads);
+
+    Roofline roofline;
+    roofline.setPeaks(Roofline::measurePeaks(threadCounts, arraySize));
+
+    VectorData<double> vec1(arraySize);
+    VectorData<double> vec2(arraySize);
+    vec1.initialize(-1.0, 1.0);
+    vec2.initialize(-1.0, 1.0);
+    double bytes = static_cast<double>(arraySize) * sizeof(double);
+    double n = static_cast<double>(arraySize);
+    volatile double sink = 0;
+
+    for (int t : threadCounts) {
+        roofline.add({"findMinParallel", t, bytes, n, Roofline::best(5, [&]() {
+            sink = ArrayHelper::findMinParallel(vec1.data, arraySize, t); })});
+        roofline.add({"findMaxParallel", t, bytes, n, Roofline::best(5, [&]() {
+            sink = ArrayHelper::findMaxParallel(vec1.data, arraySize, t); })});
+        roofline.add({"findSumParallel", t, bytes, n, Roofline::best(5, [&]() {
+            sink = ArrayHelper::findSumParallel(vec1.data, arraySize, t); })});
+        roofline.add({"findEuclidParallel", t, bytes, 2 * n, Roofline::best(5, [&]() {
+            sink = ArrayHelper::findEuclidParallel(vec1.data, arraySize, t); })});
+        roofline.add({"findManhattanParallel", t, bytes, 2 * n, Roofline::best(5, [&]() {
+            sink = ArrayHelper::findManhattanParallel(vec1.data, arraySize, t); })});
+        roofline.add({"findScalarParallel", t, 2 * bytes, 2 * n, Roofline::best(5, [&]() {
+            sink = ArrayHelper::findScalarParallel(vec1.data, vec2.data, arraySize, t); })});
+    }
+    (void)sink;
+
+    roofline.printTable();
+    roofline.exportCsv("roofline.csv");
+    std::cout << "\nРезультаты сохранены в roofline.csv" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
     setlocale(LC_ALL, "RUS");
     srand(static_cast<unsigned int>(time(0)));
 
+    if (argc > 1 && std::string(argv[1]) == "--roofline") {
+        try {
+            runRoofline(argc > 2 ? std::stoull(argv[2]) : size_t(1) << 23);
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Ошибка: " << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
     size_t arraySize;
     std::cout << "Введите размер массива: ";
     std::cin >> arraySize;
@@ -433,6 +886,8 @@ int main() {
     std::cin >> numThreads;
 
     try {
+        // Трассировка потоков параллельных методов, результат - trace.json для Perfetto
+        Tracer::instance().enable();
         std::cout << "\nПараллельные вычисления:" << std::endl;
         auto minParResult = VectorHelper::findMinParallel(newVec, numThreads);
         minParResult.print("Минимум");
@@ -449,6 +904,130 @@ int main() {
 
         auto scalarParResult = VectorHelper::findScalarParallel(newVec, newVec, numThreads);
         scalarParResult.print("Скалярное произведение с самим собой");
+
+        std::cout << "\nРазреженные вычисления:" << std::endl;
+        // Вектор, в котором ненулевой только каждый 50-й элемент
+        VectorData<double> vecSparseDense(arraySize);
+        vecSparseDense.initialize(0.0);
+        for (size_t i = 0; i < arraySize; i += 50) {
+            vecSparseDense.data[i] = newVec.data[i];
+        }
+        auto denseScalarResult = VectorHelper::findScalarParallel(vecSparseDense, vecScalar, numThreads);
+        denseScalarResult.print("Скалярное произведение (плотное)");
+        SparseVector<double> sparseVec = VectorHelper::toSparse(vecSparseDense, numThreads);
+        auto sparseScalarResult = VectorHelper::findScalarSparse(sparseVec, vecScalar, numThreads);
+        sparseScalarResult.print("Скалярное произведение (разреженное x плотное)");
+        auto sparseSelfResult = VectorHelper::findScalarSparse(sparseVec, sparseVec, numThreads);
+        sparseSelfResult.print("Скалярное произведение (разреженное x разреженное)");
+
+        Tracer::instance().disable();
+        Tracer::instance().exportChromeJson("trace.json");
+        std::cout << "\nТрассировка потоков сохранена в trace.json" << std::endl;
+
+        std::cout << "\nКонвейер (генерация -> запись -> чтение -> редукции):" << std::endl;
+        size_t chunkSize = std::max<size_t>(arraySize / 64, 1000);
+        auto pipelineResult = VectorPipeline::run(arraySize, chunkSize, minVal, maxVal, "numbers_pipeline.dat");
+        FuncResult<double>(pipelineResult.min, pipelineResult.time).print("Минимум");
+        FuncResult<double>(pipelineResult.max, pipelineResult.time).print("Максимум");
+        FuncResult<double>(pipelineResult.avg, pipelineResult.time).print("Среднее");
+        FuncResult<double>(pipelineResult.euclid, pipelineResult.time).print("Норма Евклида");
+        FuncResult<double>(pipelineResult.manhattan, pipelineResult.time).print("Манхэттенская норма");
+        const char* stageNames[VectorPipeline::numStages] = {"генерация", "запись", "чтение", "редукции"};
+        double stagesTotal = 0;
+        for (int i = 0; i < VectorPipeline::numStages; ++i) {
+            std::cout << "Стадия " << stageNames[i] << ": " << pipelineResult.stageTimes[i] << " секунд." << std::endl;
+            stagesTotal += pipelineResult.stageTimes[i];
+        }
+        std::cout << "Сумма времен стадий: " << stagesTotal << " секунд, конвейер: "
+                  << pipelineResult.time << " секунд." << std::endl;
+
+        auto start = high_resolution_clock::now();
+        double elapsed = 0;
+
+        std::cout << "\nПриближенные вычисления:" << std::endl;
+        ApproxOptions approxOptions;
+        approxOptions.targetRelError = 0.01;
+        auto approxResult = VectorHelper::findStatsApprox(newVec, numThreads, approxOptions);
+        approxResult.print("Оценка по выборке");
+
+        std::cout << "\nСжатый вектор счетчиков:" << std::endl;
+        VectorData<int> counters(arraySize);
+        for (size_t i = 0; i < arraySize; ++i) {
+            counters.data[i] = rand() % 1000;
+        }
+        CompressedVector<int> compressed = VectorHelper::toCompressed(counters, numThreads);
+        std::cout << "Размер: " << arraySize * sizeof(int) << " -> " << compressed.bytes() << " байт" << std::endl;
+        VectorHelper::findSumParallel(counters, numThreads).print("Сумма (несжатый)");
+        VectorHelper::findSumCompressed(compressed, numThreads).print("Сумма (по метаданным)");
+        VectorHelper::findMinCompressed(compressed, numThreads).print("Минимум (по метаданным)");
+        VectorHelper::findMaxCompressed(compressed, numThreads).print("Максимум (по метаданным)");
+        VectorHelper::findManhattanParallel(counters, numThreads).print("Манхэттенская норма (несжатый)");
+        VectorHelper::findManhattanCompressed(compressed, numThreads).print("Манхэттенская норма (сжатый)");
+        VectorHelper::findEuclidCompressed(compressed, numThreads).print("Норма Евклида (сжатый)");
+
+        std::cout << "\nПотоковая дозапись:" << std::endl;
+        StreamingVector<double> stream;
+        start = high_resolution_clock::now();
+        {
+            // Потоки дописывают свои части массива пакетами по 1000 элементов
+            std::vector<std::thread> appenders;
+            size_t blockSize = arraySize / numThreads;
+            for (int i = 0; i < numThreads; ++i) {
+                appenders.emplace_back([&, i]() {
+                    size_t startIdx = i * blockSize;
+                    size_t endIdx = (i == numThreads - 1) ? arraySize : startIdx + blockSize;
+                    for (size_t j = startIdx; j < endIdx; j += 1000) {
+                        stream.append(newVec.data + j, std::min<size_t>(1000, endIdx - j));
+                    }
+                });
+            }
+            for (auto& th : appenders) th.join();
+        }
+        elapsed = duration_cast<duration<double>>(high_resolution_clock::now() - start).count();
+        std::cout << "Дописано " << stream.size() << " элементов за " << elapsed << " секунд." << std::endl;
+        start = high_resolution_clock::now();
+        RunningStats<double> streamStats = stream.stats();
+        elapsed = duration_cast<duration<double>>(high_resolution_clock::now() - start).count();
+        FuncResult<double>(streamStats.min, elapsed).print("Минимум");
+        FuncResult<double>(streamStats.max, elapsed).print("Максимум");
+        FuncResult<double>(streamStats.avg(), elapsed).print("Среднее");
+        FuncResult<double>(streamStats.variance(), elapsed).print("Дисперсия");
+        FuncResult<double>(streamStats.euclid(), elapsed).print("Норма Евклида");
+        start = high_resolution_clock::now();
+        RunningStats<double> windowStats = stream.windowStats();
+        elapsed = duration_cast<duration<double>>(high_resolution_clock::now() - start).count();
+        FuncResult<double>(windowStats.avg(), elapsed).print("Среднее последних " + std::to_string(windowStats.count));
+
+        std::cout << "\nПоэлементные операции, sum((2*x + y)^2):" << std::endl;
+        auto fusedResult = VectorHelper::findSumFused(
+            VectorOps::square(2.0 * newVec.expr() + vecScalar.expr()), numThreads);
+        fusedResult.print("За один проход");
+        VectorData<double> axpyVec(arraySize);
+        start = high_resolution_clock::now();
+        std::copy(vecScalar.data, vecScalar.data + arraySize, axpyVec.data);
+        axpyVec.axpy(2.0, newVec, numThreads);
+        double norm = ArrayHelper::findEuclidParallel(axpyVec.data, arraySize, numThreads);
+        elapsed = duration_cast<duration<double>>(high_resolution_clock::now() - start).count();
+        FuncResult<double>(norm * norm, elapsed).print("Через временный вектор");
+
+        std::cout << "\nСортировка (результат - медиана):" << std::endl;
+        VectorData<double> sorted(arraySize);
+        auto sortResult = VectorHelper::sortParallel(newVec, sorted, numThreads);
+        sortResult.print("Параллельная сортировка");
+
+        std::copy(newVec.data, newVec.data + arraySize, sorted.data);
+        start = high_resolution_clock::now();
+        std::sort(sorted.data, sorted.data + arraySize);
+        elapsed = duration_cast<duration<double>>(high_resolution_clock::now() - start).count();
+        FuncResult<double>(sorted.data[arraySize / 2], elapsed).print("std::sort");
+
+#if defined(LAB3_PAR_SORT) && defined(__cpp_lib_parallel_algorithm)
+        std::copy(newVec.data, newVec.data + arraySize, sorted.data);
+        start = high_resolution_clock::now();
+        std::sort(std::execution::par, sorted.data, sorted.data + arraySize);
+        elapsed = duration_cast<duration<double>>(high_resolution_clock::now() - start).count();
+        FuncResult<double>(sorted.data[arraySize / 2], elapsed).print("std::sort(std::execution::par)");
+#endif
     }
     catch (const std::exception& e) {
         std::cerr << "Ошибка: " << e.what() << std::endl;
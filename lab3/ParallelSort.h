@@ -0,0 +1,217 @@
+#ifndef PARALLELSORT_H
+#define PARALLELSORT_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Параллельная сортировка массивов.
+// Для целых и чисел с плавающей точкой - LSD radix sort по 8 бит за проход над ключами,
+// преобразованными так, что их беззнаковый порядок совпадает с порядком чисел.
+// Для остальных типов - сортировка блоков по потокам и попарное параллельное слияние.
+struct ParallelSort {
+
+    // Сортировка на месте
+    template<typename T>
+    static void sort(T* data, size_t size, int numThreads) {
+        sort(data, data, size, numThreads);
+    }
+
+    // Сортировка в другой массив, исходный не меняется (src и dst могут совпадать)
+    template<typename T>
+    static void sort(const T* src, T* dst, size_t size, int numThreads) {
+        if (numThreads < 1) {
+            throw std::invalid_argument("Количество потоков должно быть положительным");
+        }
+        if constexpr (std::is_arithmetic_v<T> && !std::is_same_v<T, bool> &&
+                      (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8)) {
+            radixSort(src, dst, size, numThreads);
+        } else {
+            mergeSort(src, dst, size, numThreads, std::less<T>());
+        }
+    }
+
+    // Параллельная сортировка слиянием для произвольного T и компаратора
+    template<typename T, typename Compare>
+    static void mergeSort(const T* src, T* dst, size_t size, int numThreads, Compare comp) {
+        if (numThreads < 1) {
+            throw std::invalid_argument("Количество потоков должно быть положительным");
+        }
+        if (src != dst) std::copy(src, src + size, dst);
+        if (static_cast<size_t>(numThreads) > size) numThreads = size > 0 ? static_cast<int>(size) : 1;
+
+        // Границы блоков: блок i занимает [bounds[i], bounds[i + 1])
+        std::vector<size_t> bounds(numThreads + 1);
+        size_t blockSize = size / numThreads;
+        for (int i = 0; i < numThreads; ++i) bounds[i] = i * blockSize;
+        bounds[numThreads] = size;
+
+        std::vector<std::thread> threads;
+        for (int i = 0; i < numThreads; ++i) {
+            threads.emplace_back([=, &bounds]() {
+                std::sort(dst + bounds[i], dst + bounds[i + 1], comp);
+            });
+        }
+        for (auto& th : threads) th.join();
+
+        // Попарное слияние соседних отсортированных блоков, пока не останется один
+        std::vector<T> buffer(size);
+        T* from = dst;
+        T* to = buffer.data();
+        while (bounds.size() > 2) {
+            std::vector<size_t> merged;
+            threads.clear();
+            for (size_t b = 0; b + 1 < bounds.size(); b += 2) {
+                merged.push_back(bounds[b]);
+                size_t lo = bounds[b];
+                size_t mid = bounds[b + 1];
+                size_t hi = b + 2 < bounds.size() ? bounds[b + 2] : mid;
+                threads.emplace_back([=]() {
+                    std::merge(from + lo, from + mid, from + mid, from + hi, to + lo, comp);
+                });
+            }
+            merged.push_back(size);
+            for (auto& th : threads) th.join();
+            bounds = std::move(merged);
+            std::swap(from, to);
+        }
+        if (from != dst) std::copy(from, from + size, dst);
+    }
+
+    // LSD radix sort для арифметических типов
+    template<typename T>
+    static void radixSort(const T* src, T* dst, size_t size, int numThreads) {
+        using Key = typename KeyOf<sizeof(T)>::type;
+        if (static_cast<size_t>(numThreads) > size) numThreads = size > 0 ? static_cast<int>(size) : 1;
+        size_t blockSize = size / numThreads;
+
+        std::vector<Key> keys(size);
+        std::vector<Key> buffer(size);
+        Key* from = keys.data();
+        Key* to = buffer.data();
+
+        std::vector<std::thread> threads;
+        for (int i = 0; i < numThreads; ++i) {
+            threads.emplace_back([=]() {
+                size_t startIdx = i * blockSize;
+                size_t endIdx = (i == numThreads - 1) ? size : startIdx + blockSize;
+                for (size_t j = startIdx; j < endIdx; ++j) from[j] = toKey(src[j]);
+            });
+        }
+        for (auto& th : threads) th.join();
+
+        // histograms[i][d] - сколько ключей с цифрой d в блоке потока i
+        std::vector<std::vector<size_t>> histograms(numThreads, std::vector<size_t>(radix));
+        for (unsigned shift = 0; shift < sizeof(Key) * 8; shift += radixBits) {
+            threads.clear();
+            for (int i = 0; i < numThreads; ++i) {
+                threads.emplace_back([=, &histograms]() {
+                    size_t startIdx = i * blockSize;
+                    size_t endIdx = (i == numThreads - 1) ? size : startIdx + blockSize;
+                    std::vector<size_t>& hist = histograms[i];
+                    std::fill(hist.begin(), hist.end(), 0);
+                    for (size_t j = startIdx; j < endIdx; ++j) ++hist[(from[j] >> shift) & (radix - 1)];
+                });
+            }
+            for (auto& th : threads) th.join();
+
+            // Все ключи с одинаковой цифрой - проход ничего не меняет
+            bool trivial = false;
+            for (size_t d = 0; d < radix && !trivial; ++d) {
+                size_t total = 0;
+                for (int i = 0; i < numThreads; ++i) total += histograms[i][d];
+                trivial = total == size;
+            }
+            if (trivial) continue;
+
+            // Превращаем гистограммы в позиции записи: сначала по цифре, затем по потоку,
+            // чтобы сохранить устойчивость сортировки
+            size_t offset = 0;
+            for (size_t d = 0; d < radix; ++d) {
+                for (int i = 0; i < numThreads; ++i) {
+                    size_t count = histograms[i][d];
+                    histograms[i][d] = offset;
+                    offset += count;
+                }
+            }
+
+            threads.clear();
+            for (int i = 0; i < numThreads; ++i) {
+                threads.emplace_back([=, &histograms]() {
+                    size_t startIdx = i * blockSize;
+                    size_t endIdx = (i == numThreads - 1) ? size : startIdx + blockSize;
+                    std::vector<size_t>& pos = histograms[i];
+                    for (size_t j = startIdx; j < endIdx; ++j) {
+                        Key key = from[j];
+                        to[pos[(key >> shift) & (radix - 1)]++] = key;
+                    }
+                });
+            }
+            for (auto& th : threads) th.join();
+            std::swap(from, to);
+        }
+
+        threads.clear();
+        for (int i = 0; i < numThreads; ++i) {
+            threads.emplace_back([=]() {
+                size_t startIdx = i * blockSize;
+                size_t endIdx = (i == numThreads - 1) ? size : startIdx + blockSize;
+                for (size_t j = startIdx; j < endIdx; ++j) dst[j] = fromKey<T>(from[j]);
+            });
+        }
+        for (auto& th : threads) th.join();
+    }
+
+private:
+    static constexpr unsigned radixBits = 8;
+    static constexpr size_t radix = size_t(1) << radixBits;
+
+    template<size_t Bytes> struct KeyOf;
+
+    // Беззнаковый порядок ключей совпадает с порядком значений:
+    // у знаковых целых инвертируется знаковый бит; у отрицательных чисел
+    // с плавающей точкой инвертируются все биты, у неотрицательных - только знаковый
+    template<typename T>
+    static typename KeyOf<sizeof(T)>::type toKey(T value) {
+        using Key = typename KeyOf<sizeof(T)>::type;
+        constexpr Key signBit = Key(1) << (sizeof(Key) * 8 - 1);
+        Key bits;
+        std::memcpy(&bits, &value, sizeof(T));
+        if constexpr (std::is_floating_point_v<T>) {
+            return (bits & signBit) ? Key(~bits) : Key(bits | signBit);
+        } else if constexpr (std::is_signed_v<T>) {
+            return Key(bits ^ signBit);
+        } else {
+            return bits;
+        }
+    }
+
+    template<typename T>
+    static T fromKey(typename KeyOf<sizeof(T)>::type key) {
+        using Key = typename KeyOf<sizeof(T)>::type;
+        constexpr Key signBit = Key(1) << (sizeof(Key) * 8 - 1);
+        Key bits;
+        if constexpr (std::is_floating_point_v<T>) {
+            bits = (key & signBit) ? Key(key ^ signBit) : Key(~key);
+        } else if constexpr (std::is_signed_v<T>) {
+            bits = Key(key ^ signBit);
+        } else {
+            bits = key;
+        }
+        T value;
+        std::memcpy(&value, &bits, sizeof(T));
+        return value;
+    }
+};
+
+template<> struct ParallelSort::KeyOf<1> { using type = uint8_t; };
+template<> struct ParallelSort::KeyOf<2> { using type = uint16_t; };
+template<> struct ParallelSort::KeyOf<4> { using type = uint32_t; };
+template<> struct ParallelSort::KeyOf<8> { using type = uint64_t; };
+
+#endif
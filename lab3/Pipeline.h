@@ -0,0 +1,286 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <condition_variable>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <latch>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+// Конвейер на корутинах C++20: стадии - корутины, обменивающиеся данными через
+// ограниченные каналы. Пока стадия ждет места или данных в канале, ее поток
+// свободен для других стадий, поэтому стадии работают одновременно, а общее
+// время стремится к времени самой медленной стадии, а не к сумме всех.
+
+// Пул потоков, выполняющий готовые к продолжению корутины
+class Scheduler {
+public:
+    explicit Scheduler(int numThreads) {
+        if (numThreads < 1) {
+            throw std::invalid_argument("Количество потоков должно быть положительным");
+        }
+        for (int i = 0; i < numThreads; ++i) {
+            workers.emplace_back([this]() { workerLoop(); });
+        }
+    }
+
+    ~Scheduler() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        cv.notify_all();
+        for (auto& th : workers) th.join();
+    }
+
+    Scheduler(const Scheduler&) = delete;
+    Scheduler& operator=(const Scheduler&) = delete;
+
+    void post(std::coroutine_handle<> handle) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ready.push_back(handle);
+        }
+        cv.notify_one();
+    }
+
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::coroutine_handle<>> ready;
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool stopping = false;
+
+    void workerLoop() {
+        for (;;) {
+            std::coroutine_handle<> handle;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cv.wait(lock, [this]() { return stopping || !ready.empty(); });
+                if (ready.empty()) return;
+                handle = ready.front();
+                ready.pop_front();
+            }
+            handle.resume();
+        }
+    }
+};
+
+// Корутина-стадия конвейера. Запускается не сразу, а при Pipeline::run.
+class Task {
+public:
+    struct promise_type {
+        std::exception_ptr error;
+        std::latch* done = nullptr;
+
+        Task get_return_object() {
+            return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        struct FinalAwaiter {
+            bool await_ready() noexcept { return false; }
+            void await_suspend(std::coroutine_handle<promise_type> handle) noexcept {
+                // После count_down кадр может быть уничтожен владельцем, больше его не трогаем
+                std::latch* done = handle.promise().done;
+                if (done) done->count_down();
+            }
+            void await_resume() noexcept {}
+        };
+        FinalAwaiter final_suspend() noexcept { return {}; }
+
+        void return_void() {}
+        void unhandled_exception() { error = std::current_exception(); }
+    };
+
+    explicit Task(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+    Task(Task&& other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    ~Task() {
+        if (handle) handle.destroy();
+    }
+
+private:
+    std::coroutine_handle<promise_type> handle;
+
+    friend class Pipeline;
+};
+
+// Ограниченный канал между стадиями. send приостанавливает отправителя, пока
+// в буфере нет места; receive приостанавливает получателя, пока нет данных.
+// После close получатель дочитывает буфер и получает std::nullopt,
+// а send возвращает false - так стадии узнают о завершении или сбое соседей.
+template <typename T>
+class Channel {
+public:
+    Channel(Scheduler& scheduler, size_t capacity) : scheduler(scheduler), capacity(capacity) {
+        if (capacity == 0) {
+            throw std::invalid_argument("Емкость канала должна быть положительной");
+        }
+    }
+
+    Channel(const Channel&) = delete;
+    Channel& operator=(const Channel&) = delete;
+
+    struct SendAwaiter {
+        Channel* channel;
+        T value;
+        bool accepted = false;
+        std::coroutine_handle<> handle;
+
+        bool await_ready() { return false; }
+
+        bool await_suspend(std::coroutine_handle<> handle) {
+            std::coroutine_handle<> wake;
+            {
+                std::lock_guard<std::mutex> lock(channel->mutex);
+                if (channel->closed) return false;
+                accepted = true;
+                if (!channel->receivers.empty()) {
+                    // Ожидающий получатель забирает значение напрямую
+                    auto* receiver = channel->receivers.front();
+                    channel->receivers.pop_front();
+                    receiver->result = std::move(value);
+                    wake = receiver->handle;
+                } else if (channel->buffer.size() < channel->capacity) {
+                    channel->buffer.push_back(std::move(value));
+                    return false;
+                } else {
+                    accepted = false;
+                    this->handle = handle;
+                    channel->senders.push_back(this);
+                    return true;
+                }
+            }
+            channel->scheduler.post(wake);
+            return false;
+        }
+
+        bool await_resume() { return accepted; }
+    };
+
+    struct ReceiveAwaiter {
+        Channel* channel;
+        std::optional<T> result;
+        std::coroutine_handle<> handle;
+
+        bool await_ready() { return false; }
+
+        bool await_suspend(std::coroutine_handle<> handle) {
+            std::coroutine_handle<> wake;
+            {
+                std::lock_guard<std::mutex> lock(channel->mutex);
+                if (!channel->buffer.empty()) {
+                    result = std::move(channel->buffer.front());
+                    channel->buffer.pop_front();
+                    // Освободилось место - переносим значение ожидающего отправителя в буфер
+                    if (!channel->senders.empty()) {
+                        auto* sender = channel->senders.front();
+                        channel->senders.pop_front();
+                        channel->buffer.push_back(std::move(sender->value));
+                        sender->accepted = true;
+                        wake = sender->handle;
+                    }
+                } else if (channel->closed) {
+                    return false;
+                } else {
+                    this->handle = handle;
+                    channel->receivers.push_back(this);
+                    return true;
+                }
+            }
+            if (wake) channel->scheduler.post(wake);
+            return false;
+        }
+
+        std::optional<T> await_resume() { return std::move(result); }
+    };
+
+    SendAwaiter send(T value) { return SendAwaiter{this, std::move(value), false, nullptr}; }
+    ReceiveAwaiter receive() { return ReceiveAwaiter{this, std::nullopt, nullptr}; }
+
+    // Закрытие канала: будит всех ожидающих; вызывать можно с обеих сторон
+    void close() {
+        std::vector<std::coroutine_handle<>> wake;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (closed) return;
+            closed = true;
+            for (auto* receiver : receivers) wake.push_back(receiver->handle);
+            for (auto* sender : senders) wake.push_back(sender->handle);
+            receivers.clear();
+            senders.clear();
+        }
+        for (auto handle : wake) scheduler.post(handle);
+    }
+
+private:
+    Scheduler& scheduler;
+    size_t capacity;
+    std::deque<T> buffer;
+    std::deque<ReceiveAwaiter*> receivers;
+    std::deque<SendAwaiter*> senders;
+    std::mutex mutex;
+    bool closed = false;
+};
+
+// Закрывает каналы стадии при выходе из корутины, в том числе по исключению,
+// чтобы соседние стадии не ждали вечно
+template <typename... Channels>
+class ChannelGuard {
+public:
+    explicit ChannelGuard(Channels&... channels) : channels(&channels...) {}
+    ~ChannelGuard() {
+        std::apply([](auto*... channel) { (channel->close(), ...); }, channels);
+    }
+
+private:
+    std::tuple<Channels*...> channels;
+};
+
+// Набор стадий, запускаемых совместно на общем планировщике
+class Pipeline {
+public:
+    explicit Pipeline(int numThreads) : scheduler(numThreads) {}
+
+    Scheduler& getScheduler() { return scheduler; }
+
+    void addStage(Task task) {
+        stages.push_back(std::move(task));
+    }
+
+    // Запуск всех стадий и ожидание их завершения; первая ошибка стадии пробрасывается
+    void run() {
+        std::latch done(static_cast<std::ptrdiff_t>(stages.size()));
+        for (auto& stage : stages) {
+            stage.handle.promise().done = &done;
+        }
+        for (auto& stage : stages) {
+            scheduler.post(stage.handle);
+        }
+        done.wait();
+
+        std::vector<Task> finished = std::move(stages);
+        stages.clear();
+        for (auto& stage : finished) {
+            if (stage.handle.promise().error) {
+                std::rethrow_exception(stage.handle.promise().error);
+            }
+        }
+    }
+
+private:
+    Scheduler scheduler;
+    std::vector<Task> stages;
+};
+
+#endif
@@ -0,0 +1,181 @@
+#ifndef ROOFLINE_H
+#define ROOFLINE_H
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Модель roofline: производительность операции ограничена либо пиковой
+// пропускной способностью памяти, либо пиковой скоростью вычислений.
+// Сначала измеряются пики (STREAM-подобные copy/triad и цепочки FMA)
+// для каждого числа потоков, затем для каждой операции сообщается,
+// какую долю пиков она достигает.
+
+struct RooflinePeak {
+    int threads;
+    double copyGBs;    // c[i] = a[i]
+    double triadGBs;   // a[i] = b[i] + s * c[i]
+    double gflops;     // Независимые цепочки умножений-сложений в регистрах
+};
+
+struct RooflineEntry {
+    std::string name;
+    int threads;
+    double bytes;      // Байт прочитано и записано
+    double flops;      // Арифметических операций
+    double seconds;
+};
+
+class Roofline {
+public:
+    // Измерение пиков для каждого числа потоков; size - элементов в каждом из трех массивов
+    static std::vector<RooflinePeak> measurePeaks(const std::vector<int>& threadCounts,
+                                                  size_t size, int repeats = 5) {
+        std::vector<double> a(size, 1.0), b(size, 2.0), c(size, 0.0);
+        std::vector<RooflinePeak> peaks;
+        for (int numThreads : threadCounts) {
+            if (numThreads < 1) {
+                throw std::invalid_argument("Количество потоков должно быть положительным");
+            }
+            double* pa = a.data();
+            double* pb = b.data();
+            double* pc = c.data();
+
+            double copyTime = best(repeats, [=]() {
+                forBlocks(size, numThreads, [=](size_t startIdx, size_t endIdx) {
+                    for (size_t j = startIdx; j < endIdx; ++j) pc[j] = pa[j];
+                });
+            });
+            double triadTime = best(repeats, [=]() {
+                forBlocks(size, numThreads, [=](size_t startIdx, size_t endIdx) {
+                    for (size_t j = startIdx; j < endIdx; ++j) pa[j] = pb[j] + 3.0 * pc[j];
+                });
+            });
+
+            // Каждый поток крутит flopChains независимых цепочек x = x * m + k
+            std::vector<double> sink(numThreads);
+            double flopTime = best(repeats, [&sink, numThreads]() {
+                forBlocks(static_cast<size_t>(numThreads), numThreads, [&sink](size_t startIdx, size_t) {
+                    double x[flopChains];
+                    for (int k = 0; k < flopChains; ++k) x[k] = 1.0 + k * 1e-3;
+                    for (size_t it = 0; it < flopIterations; ++it) {
+                        for (int k = 0; k < flopChains; ++k) x[k] = x[k] * 0.999999 + 1e-6;
+                    }
+                    double s = 0;
+                    for (int k = 0; k < flopChains; ++k) s += x[k];
+                    sink[startIdx] = s;
+                });
+            });
+            double flops = 2.0 * flopChains * flopIterations * numThreads;
+
+            peaks.push_back(RooflinePeak{numThreads,
+                                         2.0 * size * sizeof(double) / copyTime / 1e9,
+                                         3.0 * size * sizeof(double) / triadTime / 1e9,
+                                         flops / flopTime / 1e9});
+        }
+        return peaks;
+    }
+
+    void setPeaks(std::vector<RooflinePeak> measured) {
+        peaks = std::move(measured);
+    }
+
+    const std::vector<RooflinePeak>& getPeaks() const { return peaks; }
+
+    void add(const RooflineEntry& entry) {
+        entries.push_back(entry);
+    }
+
+    // Таблица: достигнутые GB/s и GFLOP/s и их доли от пиков при том же числе потоков.
+    // Заголовки латиницей: setw считает байты, и кириллица сбивает выравнивание
+    void printTable(std::ostream& os = std::cout) const {
+        os << std::left << std::setw(10) << "threads" << std::setw(14) << "copy GB/s"
+           << std::setw(14) << "triad GB/s" << std::setw(12) << "GFLOP/s" << "\n";
+        for (const auto& p : peaks) {
+            os << std::setw(10) << p.threads << std::setw(14) << p.copyGBs
+               << std::setw(14) << p.triadGBs << std::setw(12) << p.gflops << "\n";
+        }
+        os << "\n" << std::setw(26) << "operation" << std::setw(9) << "threads" << std::setw(12) << "GB/s"
+           << std::setw(12) << "GFLOP/s" << std::setw(12) << "% BW" << std::setw(12) << "% FLOP"
+           << std::setw(10) << "FLOP/B" << "\n";
+        for (const auto& e : entries) {
+            const RooflinePeak& p = peakFor(e.threads);
+            double gbs = e.bytes / e.seconds / 1e9;
+            double gflops = e.flops / e.seconds / 1e9;
+            os << std::setw(26) << e.name << std::setw(9) << e.threads << std::setw(12) << gbs
+               << std::setw(12) << gflops << std::setw(12) << 100.0 * gbs / p.triadGBs
+               << std::setw(12) << 100.0 * gflops / p.gflops << std::setw(10) << e.flops / e.bytes << "\n";
+        }
+    }
+
+    // CSV для построения графика: одна строка на измерение, пики рядом
+    void exportCsv(const std::string& filename) const {
+        std::ofstream outFile(filename);
+        if (!outFile) {
+            throw std::runtime_error("Не удалось открыть файл для записи");
+        }
+        outFile << "operation,threads,bytes,flops,seconds,gbs,gflops,intensity,"
+                   "peak_copy_gbs,peak_triad_gbs,peak_gflops,bw_fraction,flop_fraction,roofline_gflops\n";
+        for (const auto& e : entries) {
+            const RooflinePeak& p = peakFor(e.threads);
+            double gbs = e.bytes / e.seconds / 1e9;
+            double gflops = e.flops / e.seconds / 1e9;
+            double intensity = e.flops / e.bytes;
+            outFile << e.name << "," << e.threads << "," << e.bytes << "," << e.flops << ","
+                    << e.seconds << "," << gbs << "," << gflops << "," << intensity << ","
+                    << p.copyGBs << "," << p.triadGBs << "," << p.gflops << ","
+                    << gbs / p.triadGBs << "," << gflops / p.gflops << ","
+                    << std::min(p.gflops, intensity * p.triadGBs) << "\n";
+        }
+    }
+
+    // Лучшее время из repeats запусков
+    template<typename Func>
+    static double best(int repeats, Func func) {
+        double bestTime = 0;
+        for (int r = 0; r < repeats; ++r) {
+            auto start = std::chrono::high_resolution_clock::now();
+            func();
+            auto end = std::chrono::high_resolution_clock::now();
+            double elapsed = std::chrono::duration_cast<std::chrono::duration<double>>(end - start).count();
+            if (r == 0 || elapsed < bestTime) bestTime = elapsed;
+        }
+        return bestTime;
+    }
+
+private:
+    static constexpr int flopChains = 32;
+    static constexpr size_t flopIterations = 1 << 22;
+
+    std::vector<RooflinePeak> peaks;
+    std::vector<RooflineEntry> entries;
+
+    const RooflinePeak& peakFor(int threads) const {
+        for (const auto& p : peaks) {
+            if (p.threads == threads) return p;
+        }
+        throw std::invalid_argument("Пики для " + std::to_string(threads) + " потоков не измерены");
+    }
+
+    template<typename Func>
+    static void forBlocks(size_t size, int numThreads, Func func) {
+        std::vector<std::thread> threads;
+        size_t blockSize = size / numThreads;
+        for (int i = 0; i < numThreads; ++i) {
+            threads.emplace_back([=, &func]() {
+                size_t startIdx = i * blockSize;
+                size_t endIdx = (i == numThreads - 1) ? size : startIdx + blockSize;
+                func(startIdx, endIdx);
+            });
+        }
+        for (auto& th : threads) th.join();
+    }
+};
+
+#endif
@@ -0,0 +1,229 @@
+#ifndef SPARSEVECTOR_H
+#define SPARSEVECTOR_H
+
+#include <vector>
+#include <thread>
+#include <cmath>
+#include <numeric>
+#include <algorithm>
+#include <stdexcept>
+
+// Разреженный вектор: отсортированные индексы ненулевых элементов и их значения.
+// Память и время операций пропорциональны числу ненулевых (nnz), а не длине.
+template <typename T = double>
+class SparseVector {
+public:
+    size_t size;                  // Логическая длина вектора
+    std::vector<size_t> indices;  // Индексы ненулевых элементов (по возрастанию)
+    std::vector<T> values;        // Значения ненулевых элементов
+
+    SparseVector(size_t size = 0) : size(size) {}
+
+    size_t nnz() const { return values.size(); }
+
+    // Построение из плотного массива: каждый поток считает ненулевые в своем блоке,
+    // затем по префиксным суммам пишет их сразу на свое место без слияния
+    static SparseVector<T> fromDense(const T* data, size_t size, int numThreads = 1) {
+        if (numThreads < 1) {
+            throw std::invalid_argument("Количество потоков должно быть положительным");
+        }
+        SparseVector<T> result(size);
+        std::vector<size_t> counts(numThreads, 0);
+        size_t blockSize = size / numThreads;
+
+        std::vector<std::thread> threads;
+        for (int i = 0; i < numThreads; ++i) {
+            threads.emplace_back([=, &counts]() {
+                size_t startIdx = i * blockSize;
+                size_t endIdx = (i == numThreads - 1) ? size : startIdx + blockSize;
+                size_t localCount = 0;
+                for (size_t j = startIdx; j < endIdx; ++j) {
+                    if (data[j] != T()) ++localCount;
+                }
+                counts[i] = localCount;
+            });
+        }
+        for (auto& th : threads) th.join();
+
+        std::vector<size_t> offsets(numThreads, 0);
+        std::exclusive_scan(counts.begin(), counts.end(), offsets.begin(), static_cast<size_t>(0));
+        size_t total = offsets.back() + counts.back();
+        result.indices.resize(total);
+        result.values.resize(total);
+
+        size_t* outIdx = result.indices.data();
+        T* outVal = result.values.data();
+        threads.clear();
+        for (int i = 0; i < numThreads; ++i) {
+            threads.emplace_back([=, &offsets]() {
+                size_t startIdx = i * blockSize;
+                size_t endIdx = (i == numThreads - 1) ? size : startIdx + blockSize;
+                size_t pos = offsets[i];
+                for (size_t j = startIdx; j < endIdx; ++j) {
+                    if (data[j] != T()) {
+                        outIdx[pos] = j;
+                        outVal[pos] = data[j];
+                        ++pos;
+                    }
+                }
+            });
+        }
+        for (auto& th : threads) th.join();
+        return result;
+    }
+
+    // Восстановление плотного представления в заранее выделенный массив
+    void toDense(T* data, size_t size) const {
+        if (size != this->size) {
+            throw std::invalid_argument("Размеры векторов не совпадают");
+        }
+        std::fill(data, data + size, T());
+        for (size_t k = 0; k < nnz(); ++k) {
+            data[indices[k]] = values[k];
+        }
+    }
+
+    // Скалярное произведение с плотным вектором: выборка (gather) только по ненулевым
+    T dotDense(const T* dense, size_t denseSize, int numThreads = 1) const {
+        if (denseSize != size) {
+            throw std::invalid_argument("Размеры векторов не совпадают");
+        }
+        const size_t* idx = indices.data();
+        const T* val = values.data();
+        return reduceBlocks(numThreads, [=](size_t startIdx, size_t endIdx) {
+            T localSum = 0;
+            for (size_t k = startIdx; k < endIdx; ++k) {
+                localSum += val[k] * dense[idx[k]];
+            }
+            return localSum;
+        });
+    }
+
+    // Скалярное произведение двух разреженных векторов. Если число ненулевых
+    // сильно различается, используется галопирующий поиск по большему вектору,
+    // иначе - обычное слияние отсортированных списков индексов.
+    T dot(const SparseVector<T>& other, int numThreads = 1) const {
+        if (other.size != size) {
+            throw std::invalid_argument("Размеры векторов не совпадают");
+        }
+        const SparseVector<T>& small = nnz() <= other.nnz() ? *this : other;
+        const SparseVector<T>& large = nnz() <= other.nnz() ? other : *this;
+        if (small.nnz() == 0) return T();
+
+        bool gallop = large.nnz() / small.nnz() >= galloping_ratio;
+        return small.reduceBlocks(numThreads, [&small, &large, gallop](size_t startIdx, size_t endIdx) {
+            // Начало своего участка в большем векторе находим бинарным поиском
+            size_t pos = std::lower_bound(large.indices.begin(), large.indices.end(),
+                                          small.indices[startIdx]) - large.indices.begin();
+            return gallop ? intersectGalloping(small, large, startIdx, endIdx, pos)
+                          : intersectMerge(small, large, startIdx, endIdx, pos);
+        });
+    }
+
+    T findSum(int numThreads = 1) const {
+        const T* val = values.data();
+        return reduceBlocks(numThreads, [=](size_t startIdx, size_t endIdx) {
+            T localSum = 0;
+            for (size_t k = startIdx; k < endIdx; ++k) localSum += val[k];
+            return localSum;
+        });
+    }
+
+    double findEuclid(int numThreads = 1) const {
+        const T* val = values.data();
+        T sumSq = reduceBlocks(numThreads, [=](size_t startIdx, size_t endIdx) {
+            T localSumSq = 0;
+            for (size_t k = startIdx; k < endIdx; ++k) localSumSq += val[k] * val[k];
+            return localSumSq;
+        });
+        return std::sqrt(sumSq);
+    }
+
+    T findManhattan(int numThreads = 1) const {
+        const T* val = values.data();
+        return reduceBlocks(numThreads, [=](size_t startIdx, size_t endIdx) {
+            T localSumAbs = 0;
+            for (size_t k = startIdx; k < endIdx; ++k) localSumAbs += std::abs(val[k]);
+            return localSumAbs;
+        });
+    }
+
+private:
+    // Во сколько раз nnz большего вектора должно превышать nnz меньшего,
+    // чтобы галопирующий поиск был выгоднее слияния
+    static constexpr size_t galloping_ratio = 32;
+
+    // Делит ненулевые элементы на блоки по потокам и суммирует частичные результаты
+    template <typename Func>
+    T reduceBlocks(int numThreads, Func func) const {
+        if (numThreads < 1) {
+            throw std::invalid_argument("Количество потоков должно быть положительным");
+        }
+        size_t count = nnz();
+        if (count == 0) return T();
+        if (static_cast<size_t>(numThreads) > count) numThreads = static_cast<int>(count);
+
+        std::vector<std::thread> threads;
+        std::vector<T> localSums(numThreads, 0);
+        size_t blockSize = count / numThreads;
+
+        for (int i = 0; i < numThreads; ++i) {
+            threads.emplace_back([=, &localSums, &func]() {
+                size_t startIdx = i * blockSize;
+                size_t endIdx = (i == numThreads - 1) ? count : startIdx + blockSize;
+                localSums[i] = func(startIdx, endIdx);
+            });
+        }
+        for (auto& th : threads) th.join();
+        return std::accumulate(localSums.begin(), localSums.end(), static_cast<T>(0));
+    }
+
+    static T intersectMerge(const SparseVector<T>& small, const SparseVector<T>& large,
+                            size_t startIdx, size_t endIdx, size_t pos) {
+        T localSum = 0;
+        size_t k = startIdx;
+        size_t largeCount = large.nnz();
+        while (k < endIdx && pos < largeCount) {
+            size_t a = small.indices[k];
+            size_t b = large.indices[pos];
+            if (a == b) {
+                localSum += small.values[k] * large.values[pos];
+                ++k;
+                ++pos;
+            } else if (a < b) {
+                ++k;
+            } else {
+                ++pos;
+            }
+        }
+        return localSum;
+    }
+
+    static T intersectGalloping(const SparseVector<T>& small, const SparseVector<T>& large,
+                                size_t startIdx, size_t endIdx, size_t pos) {
+        T localSum = 0;
+        size_t largeCount = large.nnz();
+        auto first = large.indices.begin();
+        for (size_t k = startIdx; k < endIdx && pos < largeCount; ++k) {
+            size_t target = small.indices[k];
+            // Экспоненциально расширяем шаг, пока не перепрыгнем искомый индекс
+            size_t step = 1;
+            size_t lo = pos;
+            size_t hi = pos;
+            while (hi < largeCount && large.indices[hi] < target) {
+                lo = hi;
+                hi = pos + step;
+                step *= 2;
+            }
+            if (hi > largeCount) hi = largeCount;
+            pos = std::lower_bound(first + lo, first + hi, target) - first;
+            if (pos < largeCount && large.indices[pos] == target) {
+                localSum += small.values[k] * large.values[pos];
+                ++pos;
+            }
+        }
+        return localSum;
+    }
+};
+
+#endif
@@ -0,0 +1,233 @@
+#ifndef STREAMINGVECTOR_H
+#define STREAMINGVECTOR_H
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// Накопленные статистики набора значений. Дисперсия считается по Уэлфорду,
+// объединение двух наборов - по формуле Чана, поэтому наборы можно копить
+// независимо (по потокам, по окнам) и сливать за O(1).
+template<typename T>
+struct RunningStats {
+    size_t count = 0;
+    double sum = 0;
+    double sumSq = 0;
+    double sumAbs = 0;
+    double mean = 0;
+    double m2 = 0;      // Сумма квадратов отклонений от среднего
+    T min = std::numeric_limits<T>::max();
+    T max = std::numeric_limits<T>::lowest();
+
+    void add(T value) {
+        double x = static_cast<double>(value);
+        ++count;
+        sum += x;
+        sumSq += x * x;
+        sumAbs += std::abs(x);
+        double delta = x - mean;
+        mean += delta / count;
+        m2 += delta * (x - mean);
+        if (value < min) min = value;
+        if (value > max) max = value;
+    }
+
+    void merge(const RunningStats<T>& other) {
+        if (other.count == 0) return;
+        if (count == 0) {
+            *this = other;
+            return;
+        }
+        double total = static_cast<double>(count + other.count);
+        double delta = other.mean - mean;
+        m2 += other.m2 + delta * delta * count * other.count / total;
+        mean += delta * other.count / total;
+        count += other.count;
+        sum += other.sum;
+        sumSq += other.sumSq;
+        sumAbs += other.sumAbs;
+        min = std::min(min, other.min);
+        max = std::max(max, other.max);
+    }
+
+    double avg() const { return mean; }
+    double variance() const { return count > 1 ? m2 / (count - 1) : 0.0; }
+    double euclid() const { return std::sqrt(sumSq); }
+    double manhattan() const { return sumAbs; }
+};
+
+// Вектор с дозаписью в конец и инкрементальными статистиками.
+// Элементы хранятся сегментами, которые никогда не перемещаются, поэтому
+// дозапись не копирует данные, а место под элементы выдается атомарным
+// счетчиком. Статистики копятся в шардах: каждый поток пишет в свой шард
+// под его собственной блокировкой, глобальной блокировки нет.
+// Запросы объединяют шарды и не зависят от числа элементов.
+// Скользящее окно - последние windowBuckets корзин по bucketSize элементов.
+template<typename T>
+class StreamingVector {
+public:
+    StreamingVector(size_t bucketSize = 4096, size_t windowBuckets = 16, size_t shardCount = 16)
+        : bucketSize(bucketSize), windowBuckets(windowBuckets), numShards(shardCount),
+          shards(new Shard[shardCount]), segments(new std::atomic<T*>[maxSegments]) {
+        if (bucketSize == 0 || windowBuckets == 0 || shardCount == 0) {
+            throw std::invalid_argument("Некорректные параметры потокового вектора");
+        }
+        for (size_t s = 0; s < numShards; ++s) {
+            // Кольцо на одну корзину длиннее окна: в нее пишут, пока окно читается
+            shards[s].window.resize(windowBuckets + 1);
+        }
+        for (size_t k = 0; k < maxSegments; ++k) segments[k].store(nullptr, std::memory_order_relaxed);
+    }
+
+    ~StreamingVector() {
+        for (size_t k = 0; k < maxSegments; ++k) delete[] segments[k].load(std::memory_order_relaxed);
+    }
+
+    StreamingVector(const StreamingVector&) = delete;
+    StreamingVector& operator=(const StreamingVector&) = delete;
+
+    void append(T value) {
+        append(&value, 1);
+    }
+
+    // Пакетная дозапись: место резервируется одним CAS, статистики пакета
+    // копятся локально и вливаются в шард один раз
+    void append(const T* values, size_t count) {
+        if (count == 0) return;
+        // Емкость проверяется до резервирования: за reserved не остается
+        // индексов, которые никогда не будут записаны
+        size_t first = reserved.load(std::memory_order_relaxed);
+        do {
+            if (count > maxSegments * segmentSize - first) {
+                throw std::length_error("Превышена емкость потокового вектора");
+            }
+        } while (!reserved.compare_exchange_weak(first, first + count, std::memory_order_relaxed));
+
+        RunningStats<T> batch;
+        Shard& shard = shards[threadIndex() % numShards];
+        size_t i = 0;
+        while (i < count) {
+            size_t slot = first + i;
+            size_t bucket = slot / bucketSize;
+            size_t bucketEnd = std::min(count, i + (bucket + 1) * bucketSize - slot);
+            RunningStats<T> bucketStats;
+            for (; i < bucketEnd; ++i) {
+                size_t pos = first + i;
+                segment(pos / segmentSize)[pos % segmentSize] = values[i];
+                bucketStats.add(values[i]);
+            }
+            batch.merge(bucketStats);
+
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            WindowBucket& entry = shard.window[bucket % shard.window.size()];
+            if (entry.id == noBucket || entry.id < bucket) {
+                entry.id = bucket;
+                entry.stats = RunningStats<T>();
+            }
+            // Запоздавшая запись в корзину, уже вытесненную из кольца, в окно не попадает
+            if (entry.id == bucket) entry.stats.merge(bucketStats);
+        }
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.total.merge(batch);
+        }
+        // Пакеты публикуются в порядке резервирования: committed растет только
+        // после того, как записаны все элементы перед first
+        while (committed.load(std::memory_order_acquire) != first) std::this_thread::yield();
+        committed.store(first + count, std::memory_order_release);
+    }
+
+    // Длина записанного префикса: все элементы с меньшими индексами записаны
+    size_t size() const { return committed.load(std::memory_order_acquire); }
+
+    // Чтение элемента записанного префикса; можно вызывать во время дозаписи
+    T get(size_t i) const {
+        if (i >= size()) {
+            throw std::out_of_range("Индекс за пределами вектора");
+        }
+        return segments[i / segmentSize].load(std::memory_order_acquire)[i % segmentSize];
+    }
+
+    // Статистики всех элементов
+    RunningStats<T> stats() const {
+        RunningStats<T> result;
+        for (size_t s = 0; s < numShards; ++s) {
+            std::lock_guard<std::mutex> lock(shards[s].mutex);
+            result.merge(shards[s].total);
+        }
+        return result;
+    }
+
+    // Статистики скользящего окна: последняя (возможно, неполная) корзина и windowBuckets - 1 перед ней
+    RunningStats<T> windowStats() const {
+        size_t count = reserved.load(std::memory_order_relaxed);
+        RunningStats<T> result;
+        if (count == 0) return result;
+        size_t last = (count - 1) / bucketSize;
+        size_t first = last + 1 >= windowBuckets ? last + 1 - windowBuckets : 0;
+        for (size_t s = 0; s < numShards; ++s) {
+            std::lock_guard<std::mutex> lock(shards[s].mutex);
+            for (const WindowBucket& entry : shards[s].window) {
+                if (entry.id != noBucket && entry.id >= first && entry.id <= last) {
+                    result.merge(entry.stats);
+                }
+            }
+        }
+        return result;
+    }
+
+    size_t windowSize() const { return windowBuckets * bucketSize; }
+
+private:
+    static constexpr size_t segmentSize = size_t(1) << 16;
+    static constexpr size_t maxSegments = size_t(1) << 16;
+    static constexpr size_t noBucket = std::numeric_limits<size_t>::max();
+
+    struct WindowBucket {
+        size_t id = noBucket;
+        RunningStats<T> stats;
+    };
+
+    // Шард выровнен на кэш-линию, чтобы потоки разных шардов не мешали друг другу
+    struct alignas(64) Shard {
+        mutable std::mutex mutex;
+        RunningStats<T> total;
+        std::vector<WindowBucket> window;
+    };
+
+    size_t bucketSize;
+    size_t windowBuckets;
+    size_t numShards;
+    std::unique_ptr<Shard[]> shards;
+    std::unique_ptr<std::atomic<T*>[]> segments;
+    std::atomic<size_t> reserved{0};
+    std::atomic<size_t> committed{0};
+
+    // Сегмент создается первым обратившимся к нему потоком
+    T* segment(size_t k) {
+        T* current = segments[k].load(std::memory_order_acquire);
+        if (current) return current;
+        T* fresh = new T[segmentSize];
+        if (segments[k].compare_exchange_strong(current, fresh, std::memory_order_acq_rel)) {
+            return fresh;
+        }
+        delete[] fresh;
+        return current;
+    }
+
+    // Номер потока: первые потоки получают разные шарды
+    static size_t threadIndex() {
+        static std::atomic<size_t> next{0};
+        thread_local size_t index = next.fetch_add(1, std::memory_order_relaxed);
+        return index;
+    }
+};
+
+#endif
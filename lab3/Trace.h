@@ -0,0 +1,188 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Событие трассировки: интервал [begin, end] на одном потоке
+struct TraceEvent {
+    const char* name;      // Что происходило: "chunk", "spawn", "join", ...
+    const char* category;  // Где: имя функции ArrayHelper
+    uint64_t begin;        // Наносекунды от начала трассировки
+    uint64_t end;
+    uint64_t arg0;         // Например, начало и конец блока данных
+    uint64_t arg1;
+};
+
+// Кольцевой буфер событий одного потока. Пишет в него только поток-владелец,
+// поэтому запись не требует синхронизации; при переполнении старые события затираются.
+struct TraceBuffer {
+    uint32_t tid;
+    uint64_t written = 0;
+    std::vector<TraceEvent> events;
+
+    TraceBuffer(uint32_t tid, size_t capacity) : tid(tid), events(capacity) {}
+
+    void push(const TraceEvent& event) {
+        events[written % events.size()] = event;
+        ++written;
+    }
+};
+
+// Глобальный трассировщик. Выключенный стоит одну relaxed-загрузку флага на событие.
+// Буферы переиспользуются: поток при завершении возвращает свой буфер в пул,
+// так что короткоживущие потоки из find*Parallel занимают одни и те же дорожки.
+class Tracer {
+public:
+    static Tracer& instance() {
+        static Tracer tracer;
+        return tracer;
+    }
+
+    static bool enabled() {
+        return instance()._enabled.load(std::memory_order_relaxed);
+    }
+
+    // Текущее время или 0, если трассировка выключена
+    static uint64_t now() {
+        if (!enabled()) return 0;
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - instance()._epoch).count());
+    }
+
+    // Запись завершенного интервала в буфер текущего потока
+    static void record(const char* name, const char* category, uint64_t begin, uint64_t end,
+                       uint64_t arg0 = 0, uint64_t arg1 = 0) {
+        if (!enabled()) return;
+        localBuffer().push(TraceEvent{name, category, begin, end, arg0, arg1});
+    }
+
+    void enable(size_t capacityPerThread = 4096) {
+        if (capacityPerThread == 0) {
+            throw std::invalid_argument("Емкость буфера трассировки должна быть положительной");
+        }
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _capacity = capacityPerThread;
+        }
+        // Включающий поток получает первую дорожку (tid 0, "main")
+        localBuffer();
+        _enabled.store(true, std::memory_order_relaxed);
+    }
+
+    void disable() {
+        _enabled.store(false, std::memory_order_relaxed);
+    }
+
+    // Сброс всех накопленных событий; вызывать, когда рабочие потоки завершены
+    void clear() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (auto& buffer : _buffers) buffer->written = 0;
+        _epoch = std::chrono::steady_clock::now();
+    }
+
+    // Выгрузка в формате Chrome trace_event (открывается в Perfetto и chrome://tracing).
+    // Вызывать после join всех рабочих потоков.
+    void exportChromeJson(const std::string& filename) {
+        std::ofstream outFile(filename);
+        if (!outFile) {
+            throw std::runtime_error("Не удалось открыть файл для записи трассировки");
+        }
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        outFile << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+        bool first = true;
+        for (auto& buffer : _buffers) {
+            if (!first) outFile << ",\n";
+            first = false;
+            outFile << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->tid
+                    << ",\"args\":{\"name\":\"" << (buffer->tid == 0 ? "main" : "worker ")
+                    << (buffer->tid == 0 ? "" : std::to_string(buffer->tid)) << "\"}}";
+
+            size_t capacity = buffer->events.size();
+            uint64_t count = buffer->written < capacity ? buffer->written : capacity;
+            for (uint64_t k = buffer->written - count; k < buffer->written; ++k) {
+                const TraceEvent& e = buffer->events[k % capacity];
+                outFile << ",\n{\"name\":\"" << e.name << "\",\"cat\":\"" << e.category
+                        << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->tid
+                        << ",\"ts\":" << e.begin / 1000 << "." << formatFraction(e.begin % 1000)
+                        << ",\"dur\":" << (e.end - e.begin) / 1000 << "."
+                        << formatFraction((e.end - e.begin) % 1000)
+                        << ",\"args\":{\"begin\":" << e.arg0 << ",\"end\":" << e.arg1 << "}}";
+            }
+        }
+        outFile << "\n]}\n";
+    }
+
+private:
+    std::atomic<bool> _enabled{false};
+    std::chrono::steady_clock::time_point _epoch = std::chrono::steady_clock::now();
+    std::mutex _mutex;
+    size_t _capacity = 4096;
+    std::vector<std::unique_ptr<TraceBuffer>> _buffers;  // Все когда-либо созданные буферы
+    std::vector<TraceBuffer*> _free;                     // Буферы завершившихся потоков
+
+    Tracer() = default;
+
+    // Держатель буфера потока: при завершении потока возвращает буфер в пул
+    struct LocalHandle {
+        TraceBuffer* buffer = nullptr;
+        ~LocalHandle() {
+            if (buffer) {
+                Tracer& tracer = Tracer::instance();
+                std::lock_guard<std::mutex> lock(tracer._mutex);
+                tracer._free.push_back(buffer);
+            }
+        }
+    };
+
+    static TraceBuffer& localBuffer() {
+        thread_local LocalHandle handle;
+        if (!handle.buffer) handle.buffer = instance().acquire();
+        return *handle.buffer;
+    }
+
+    TraceBuffer* acquire() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_free.empty()) {
+            TraceBuffer* buffer = _free.back();
+            _free.pop_back();
+            return buffer;
+        }
+        _buffers.push_back(std::make_unique<TraceBuffer>(static_cast<uint32_t>(_buffers.size()), _capacity));
+        return _buffers.back().get();
+    }
+
+    static std::string formatFraction(uint64_t ns) {
+        std::string s = std::to_string(ns);
+        return std::string(3 - s.size(), '0') + s;
+    }
+};
+
+// RAII-интервал: время от создания до разрушения объекта
+class TraceScope {
+public:
+    TraceScope(const char* name, const char* category, uint64_t arg0 = 0, uint64_t arg1 = 0)
+        : _name(name), _category(category), _begin(Tracer::now()), _arg0(arg0), _arg1(arg1) {}
+
+    ~TraceScope() {
+        if (_begin != 0) {
+            Tracer::record(_name, _category, _begin, Tracer::now(), _arg0, _arg1);
+        }
+    }
+
+private:
+    const char* _name;
+    const char* _category;
+    uint64_t _begin;
+    uint64_t _arg0, _arg1;
+};
+
+#endif
@@ -0,0 +1,245 @@
+#ifndef VECTOROPS_H
+#define VECTOROPS_H
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Поэлементные операции BLAS-1 над массивами и их слияние в один проход.
+// Выражение вида a * x + y не вычисляется сразу, а строит легкое дерево узлов;
+// VectorOps::assign и VectorOps::sum проходят по памяти один раз, вычисляя
+// все выражение для каждого элемента без временных массивов.
+// Внутренние циклы простые и без ветвлений; GCC 12 векторизует их при -O3
+// (при -O2 его модель стоимости такие циклы не векторизует).
+
+// Лист выражения: массив
+template<typename T>
+struct VecRef {
+    using value_type = T;
+    const T* data;
+    size_t size;
+
+    T operator[](size_t i) const { return data[i]; }
+};
+
+// Лист выражения: скаляр, одинаковый для всех элементов
+template<typename T>
+struct VecScalar {
+    using value_type = T;
+    T value;
+
+    T operator[](size_t) const { return value; }
+};
+
+template<typename L, typename R, typename Op>
+struct VecBinary {
+    using value_type = std::common_type_t<typename L::value_type, typename R::value_type>;
+    L left;
+    R right;
+    size_t length;    // Общая длина листов-массивов, проверяется при построении
+
+    value_type operator[](size_t i) const { return Op::apply(left[i], right[i]); }
+};
+
+template<typename E, typename Op>
+struct VecUnary {
+    using value_type = typename E::value_type;
+    E expr;
+    Op op;
+
+    value_type operator[](size_t i) const { return op(expr[i]); }
+};
+
+template<typename E> struct IsVecExpr : std::false_type {};
+template<typename T> struct IsVecExpr<VecRef<T>> : std::true_type {};
+template<typename T> struct IsVecExpr<VecScalar<T>> : std::true_type {};
+template<typename L, typename R, typename Op> struct IsVecExpr<VecBinary<L, R, Op>> : std::true_type {};
+template<typename E, typename Op> struct IsVecExpr<VecUnary<E, Op>> : std::true_type {};
+
+template<typename E>
+concept VecExpression = IsVecExpr<std::remove_cvref_t<E>>::value;
+
+// Длина выражения - длина его листов-массивов; у скаляра своей длины нет
+inline constexpr size_t anyVecLength = static_cast<size_t>(-1);
+
+template<typename T>
+size_t vecLength(const VecRef<T>& expr) { return expr.size; }
+
+template<typename T>
+size_t vecLength(const VecScalar<T>&) { return anyVecLength; }
+
+template<typename L, typename R, typename Op>
+size_t vecLength(const VecBinary<L, R, Op>& expr) { return expr.length; }
+
+template<typename E, typename Op>
+size_t vecLength(const VecUnary<E, Op>& expr) { return vecLength(expr.expr); }
+
+struct VecAdd { template<typename A, typename B> static auto apply(A a, B b) { return a + b; } };
+struct VecSub { template<typename A, typename B> static auto apply(A a, B b) { return a - b; } };
+struct VecMul { template<typename A, typename B> static auto apply(A a, B b) { return a * b; } };
+
+template<typename L, typename R>
+concept VecOperands = (VecExpression<L> || VecExpression<R>) &&
+                      (VecExpression<L> || std::is_arithmetic_v<L>) &&
+                      (VecExpression<R> || std::is_arithmetic_v<R>);
+
+// Узел бинарной операции; скаляр приводится к типу элементов другого операнда.
+// Длины операндов-массивов должны совпадать
+template<typename Op, typename L, typename R>
+auto makeVecBinary(const L& left, const R& right) {
+    if constexpr (!VecExpression<L>) {
+        using T = typename R::value_type;
+        return VecBinary<VecScalar<T>, R, Op>{VecScalar<T>{static_cast<T>(left)}, right, vecLength(right)};
+    } else if constexpr (!VecExpression<R>) {
+        using T = typename L::value_type;
+        return VecBinary<L, VecScalar<T>, Op>{left, VecScalar<T>{static_cast<T>(right)}, vecLength(left)};
+    } else {
+        size_t leftLength = vecLength(left), rightLength = vecLength(right);
+        if (leftLength != anyVecLength && rightLength != anyVecLength && leftLength != rightLength) {
+            throw std::invalid_argument("Размеры векторов не совпадают");
+        }
+        return VecBinary<L, R, Op>{left, right, leftLength != anyVecLength ? leftLength : rightLength};
+    }
+}
+
+template<typename L, typename R> requires VecOperands<L, R>
+auto operator+(const L& left, const R& right) {
+    return makeVecBinary<VecAdd>(left, right);
+}
+
+template<typename L, typename R> requires VecOperands<L, R>
+auto operator-(const L& left, const R& right) {
+    return makeVecBinary<VecSub>(left, right);
+}
+
+template<typename L, typename R> requires VecOperands<L, R>
+auto operator*(const L& left, const R& right) {
+    return makeVecBinary<VecMul>(left, right);
+}
+
+struct VectorOps {
+
+    template<typename T>
+    static VecRef<T> vec(const T* data, size_t size) { return VecRef<T>{data, size}; }
+
+    // Ленивые поэлементные функции
+    template<VecExpression E>
+    static auto square(const E& expr) {
+        using T = typename E::value_type;
+        auto op = [](T v) { return v * v; };
+        return VecUnary<E, decltype(op)>{expr, op};
+    }
+
+    template<VecExpression E>
+    static auto abs(const E& expr) {
+        using T = typename E::value_type;
+        auto op = [](T v) { return v < T() ? -v : v; };
+        return VecUnary<E, decltype(op)>{expr, op};
+    }
+
+    template<VecExpression E, typename T = typename E::value_type>
+    static auto clamp(const E& expr, T lo, T hi) {
+        if (hi < lo) {
+            throw std::invalid_argument("Нижняя граница больше верхней");
+        }
+        auto op = [lo, hi](T v) { return v < lo ? lo : (hi < v ? hi : v); };
+        return VecUnary<E, decltype(op)>{expr, op};
+    }
+
+    // Длина выражения; выражение из одних скаляров длины не имеет
+    template<VecExpression E>
+    static size_t length(const E& expr) {
+        size_t size = vecLength(expr);
+        if (size == anyVecLength) {
+            throw std::invalid_argument("Длина выражения не определена: в нем нет ни одного вектора");
+        }
+        return size;
+    }
+
+    // Вычисление выражения в dst (length(expr) элементов) за один проход. dst может
+    // совпадать с листом выражения: i-й элемент зависит только от i-х элементов операндов.
+    template<typename T, VecExpression E>
+    static void assign(T* dst, const E& expr, int numThreads) {
+        forBlocks(length(expr), numThreads, [dst, &expr](int, size_t startIdx, size_t endIdx) {
+            for (size_t j = startIdx; j < endIdx; ++j) {
+                dst[j] = expr[j];
+            }
+        });
+    }
+
+    // Сумма элементов выражения за один проход, без промежуточных массивов
+    template<VecExpression E>
+    static typename E::value_type sum(const E& expr, int numThreads) {
+        using T = typename E::value_type;
+        std::vector<T> localSums(std::max(numThreads, 1), 0);
+        forBlocks(length(expr), numThreads, [&expr, &localSums](int i, size_t startIdx, size_t endIdx) {
+            T localSum = 0;
+            for (size_t j = startIdx; j < endIdx; ++j) {
+                localSum += expr[j];
+            }
+            localSums[i] = localSum;
+        });
+        return std::accumulate(localSums.begin(), localSums.end(), static_cast<T>(0));
+    }
+
+    // Готовые операции BLAS-1
+
+    // y = a * x + y
+    template<typename T>
+    static void axpy(T a, const T* x, T* y, size_t size, int numThreads) {
+        assign(y, a * vec(x, size) + vec<T>(y, size), numThreads);
+    }
+
+    // x = a * x
+    template<typename T>
+    static void scale(T a, T* x, size_t size, int numThreads) {
+        assign(x, a * vec<T>(x, size), numThreads);
+    }
+
+    // z = x + y
+    template<typename T>
+    static void add(const T* x, const T* y, T* z, size_t size, int numThreads) {
+        assign(z, vec(x, size) + vec(y, size), numThreads);
+    }
+
+    // z = x * y (поэлементно)
+    template<typename T>
+    static void multiply(const T* x, const T* y, T* z, size_t size, int numThreads) {
+        assign(z, vec(x, size) * vec(y, size), numThreads);
+    }
+
+    // x = min(max(x, lo), hi)
+    template<typename T>
+    static void clamp(T* x, size_t size, T lo, T hi, int numThreads) {
+        assign(x, clamp(vec<T>(x, size), lo, hi), numThreads);
+    }
+
+private:
+    // Границы блоков выравниваются на 64 элемента, чтобы соседние потоки
+    // не писали в одну кэш-линию
+    static constexpr size_t blockAlign = 64;
+
+    template<typename Func>
+    static void forBlocks(size_t size, int numThreads, Func func) {
+        if (numThreads < 1) {
+            throw std::invalid_argument("Количество потоков должно быть положительным");
+        }
+        size_t blockSize = (size / numThreads + blockAlign - 1) / blockAlign * blockAlign;
+
+        std::vector<std::thread> threads;
+        for (int i = 0; i < numThreads; ++i) {
+            threads.emplace_back([=, &func]() {
+                size_t startIdx = std::min(size, i * blockSize);
+                size_t endIdx = (i == numThreads - 1) ? size : std::min(size, startIdx + blockSize);
+                func(i, startIdx, endIdx);
+            });
+        }
+        for (auto& th : threads) th.join();
+    }
+};
+
+#endif